@@ -0,0 +1,143 @@
+#version 450 core
+
+// one invocation per instance, survivors are appended to their draw command
+layout (local_size_x = 64) in;
+
+// the part of Object in phong.vs read here
+struct Object {
+  mat4 model;
+  mat4 model_view_projection;
+  mat3 normal_matrix;
+  vec4 color;
+};
+
+// DrawElementsIndirectCommand
+struct Command {
+  uint count;
+  uint instance_count;
+  uint first_index;
+  int base_vertex;
+  uint base_instance;
+};
+
+// object space bounds of the command's mesh
+struct Bounds {
+  vec4 min;
+  vec4 max;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+  Object objects[];
+};
+
+// object index per instance
+layout (std430, binding = 1) readonly buffer Instances {
+  uint instances[];
+};
+
+layout (std430, binding = 2) readonly buffer InstanceCommands {
+  uint instance_commands[];
+};
+
+layout (std430, binding = 3) readonly buffer CommandBounds {
+  Bounds command_bounds[];
+};
+
+layout (std430, binding = 4) buffer Commands {
+  Command commands[];
+};
+
+layout (std430, binding = 5) writeonly buffer VisibleInstances {
+  uint visible_instances[];
+};
+
+uniform uint instance_count;
+
+// farthest depth of last frame per texel on every level, seen through previous_view_projection
+uniform bool occlusion;
+uniform sampler2D depth_pyramid;
+uniform mat4 previous_view_projection;
+
+vec4 corners[8];
+
+void transformCorners(mat4 matrix, Bounds bounds) {
+  for (int i = 0; i < 8; ++i) {
+    vec3 corner = vec3((i & 1) != 0 ? bounds.max.x : bounds.min.x,
+                       (i & 2) != 0 ? bounds.max.y : bounds.min.y,
+                       (i & 4) != 0 ? bounds.max.z : bounds.min.z);
+    corners[i] = matrix * vec4(corner, 1.0);
+  }
+}
+
+// outside when every corner is beyond the same clip plane, -w <= xyz <= w is inside all six
+bool isInsideFrustum() {
+  vec3 below = vec3(-3.0e38);
+  vec3 above = vec3(-3.0e38);
+  for (int i = 0; i < 8; ++i) {
+    below = max(below, corners[i].xyz + corners[i].w);
+    above = max(above, corners[i].w - corners[i].xyz);
+  }
+  return all(greaterThanEqual(below, vec3(0.0))) && all(greaterThanEqual(above, vec3(0.0)));
+}
+
+bool isOccluded() {
+  vec3 ndc_min = vec3(1.0);
+  vec3 ndc_max = vec3(-1.0);
+  for (int i = 0; i < 8; ++i) {
+    // crossing the near plane, the screen rect is unbounded
+    if (corners[i].w <= 0.0) {
+      return false;
+    }
+    vec3 ndc = corners[i].xyz / corners[i].w;
+    ndc_min = min(ndc_min, ndc);
+    ndc_max = max(ndc_max, ndc);
+  }
+
+  ivec2 size = textureSize(depth_pyramid, 0);
+  vec2 pixel_min = clamp(ndc_min.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(size);
+  vec2 pixel_max = clamp(ndc_max.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(size);
+
+  // the level where the rect spans at most two texels each way
+  vec2 extent = max(pixel_max - pixel_min, vec2(1.0));
+  int levels = textureQueryLevels(depth_pyramid);
+  int level = clamp(int(ceil(log2(max(extent.x, extent.y)))), 0, levels - 1);
+
+  ivec2 last = max(textureSize(depth_pyramid, level) - 1, ivec2(0));
+  ivec2 first_texel = min(ivec2(pixel_min) >> level, last);
+  ivec2 last_texel = min(ivec2(min(pixel_max, vec2(size) - 1.0)) >> level, last);
+
+  float farthest = 0.0;
+  for (int y = first_texel.y; y <= last_texel.y; ++y) {
+    for (int x = first_texel.x; x <= last_texel.x; ++x) {
+      farthest = max(farthest, texelFetch(depth_pyramid, ivec2(x, y), level).r);
+    }
+  }
+
+  return ndc_min.z * 0.5 + 0.5 > farthest;
+}
+
+void main() {
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= instance_count) {
+    return;
+  }
+
+  uint object = instances[index];
+  uint command = instance_commands[index];
+  Bounds bounds = command_bounds[command];
+
+  transformCorners(objects[object].model_view_projection, bounds);
+  if (!isInsideFrustum()) {
+    return;
+  }
+
+  if (occlusion) {
+    transformCorners(previous_view_projection * objects[object].model, bounds);
+    if (isOccluded()) {
+      return;
+    }
+  }
+
+  uint slot = atomicAdd(commands[command].instance_count, 1u);
+  visible_instances[commands[command].base_instance + slot] = object;
+}
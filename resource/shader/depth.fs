@@ -0,0 +1,5 @@
+#version 450 core
+
+// depth only, color writes are masked while this runs
+void main() {
+}
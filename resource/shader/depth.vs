@@ -0,0 +1,26 @@
+#version 450 core
+
+// positions only, the depth pre-pass reads nothing else
+layout (location = 0) in vec3 vertex_position;
+
+// per instance, from the instance buffer
+layout (location = 3) in uint object_index;
+
+// same layout as phong.vs, see ObjectBuffer
+struct Object {
+  mat4 model;
+  mat4 model_view_projection;
+  mat3 normal_matrix;
+  vec4 color;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+  Object objects[];
+};
+
+// the color pass tests for equal depth, both passes have to compute the very same position
+invariant gl_Position;
+
+void main() {
+  gl_Position = objects[object_index].model_view_projection * vec4(vertex_position, 1.0);
+}
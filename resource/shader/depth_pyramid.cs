@@ -0,0 +1,32 @@
+#version 450 core
+
+// One level of the depth pyramid, each texel keeps the farthest depth of the source texels it
+// covers. Level 0 copies the depth buffer, the source has the same size there.
+layout (local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D source;
+uniform int source_level;
+
+layout (r32f, binding = 0) writeonly uniform image2D destination;
+
+void main() {
+  ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 size = imageSize(destination);
+  if (any(greaterThanEqual(position, size))) {
+    return;
+  }
+
+  // an odd source size makes the last texel of a row or column cover three source texels
+  ivec2 source_size = textureSize(source, source_level);
+  ivec2 first = position * source_size / size;
+  ivec2 last = max((position + 1) * source_size / size - 1, first);
+
+  float farthest = 0.0;
+  for (int y = first.y; y <= last.y; ++y) {
+    for (int x = first.x; x <= last.x; ++x) {
+      farthest = max(farthest, texelFetch(source, ivec2(x, y), source_level).r);
+    }
+  }
+
+  imageStore(destination, position, vec4(farthest));
+}
@@ -4,9 +4,19 @@
 layout (location = 0) in vec3 vertex_position;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// camera and light, written once a frame, see FrameData
+layout (std140, binding = 0) uniform FrameData {
+  mat4 view;
+  mat4 projection;
+  mat4 view_projection;
+  vec3 camera_position;
+  vec4 light_color;
+  vec3 light_position;
+  float ambient_strength;
+  float specular_strength;
+} frame;
 
 void main() {
-  gl_Position = projection * view * model * vec4(vertex_position, 1.0);
+  gl_Position = frame.view_projection * model * vec4(vertex_position, 1.0);
 }
@@ -2,37 +2,45 @@
 
 in vec3 normal;
 in vec3 vertex_global_position;
+in float occlusion;
+in vec4 object_color;
 
 out vec4 FragColor;
 
-uniform float ambient_strength;
-uniform float specular_strength;
-
-uniform vec4 object_color;
-uniform vec4 light_color;
-uniform vec3 light_position;
-uniform vec3 camera_position;
+// camera and light, written once a frame, see FrameData
+layout (std140, binding = 0) uniform FrameData {
+  mat4 view;
+  mat4 projection;
+  mat4 view_projection;
+  vec3 camera_position;
+  vec4 light_color;
+  vec3 light_position;
+  float ambient_strength;
+  float specular_strength;
+} frame;
 
 void main() {
+  // AMBIENT_LIGHT variants are the ones for a light with a positive ambient strength
   vec3 ambient = vec3(0.0, 0.0, 0.0);
-  if (ambient_strength > 0.0) {
-    ambient = ambient_strength * light_color.rgb;
-  }
+#ifdef AMBIENT_LIGHT
+  ambient = frame.ambient_strength * frame.light_color.rgb;
+#endif
 
   vec3 normal_vec = normalize(normal);
-  vec3 light_dir = normalize(light_position - vertex_global_position);
+  vec3 light_dir = normalize(frame.light_position - vertex_global_position);
   float diff = max(dot(normal_vec, light_dir), 0.0);
-  vec3 diffuse = diff * light_color.rgb;
+  vec3 diffuse = diff * frame.light_color.rgb;
 
   vec3 specular = vec3(0.0, 0.0, 0.0);
-  if (ambient_strength > 0.0) {
-    vec3 view_dir = normalize(camera_position - vertex_global_position);
-    vec3 reflect_dir = reflect(-light_dir, normal_vec);
-    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), 32);
-    specular = specular_strength * spec * light_color.rgb;
-  }
-
-  vec3 result = (ambient + diffuse + specular) * object_color.rgb;
+#ifdef AMBIENT_LIGHT
+  vec3 view_dir = normalize(frame.camera_position - vertex_global_position);
+  vec3 reflect_dir = reflect(-light_dir, normal_vec);
+  float spec = pow(max(dot(view_dir, reflect_dir), 0.0), 32);
+  specular = frame.specular_strength * spec * frame.light_color.rgb;
+#endif
+
+  // baked ambient occlusion darkens the indirect and diffuse terms, highlights stay
+  vec3 result = ((ambient + diffuse) * occlusion + specular) * object_color.rgb;
 
   FragColor = vec4(result.rgb, 1.0);
 }
@@ -3,18 +3,39 @@
 // get input into vec3(Type) aPos(name) in location 0
 layout (location = 0) in vec3 vertex_position;
 layout (location = 1) in vec3 vertex_normal;
+layout (location = 2) in float vertex_occlusion;
+
+// per instance, from the instance buffer or the current generic value when not instanced
+layout (location = 3) in uint object_index;
+
+// matrices are derived on the CPU once a frame, see ObjectBuffer
+struct Object {
+  mat4 model;
+  mat4 model_view_projection;
+  mat3 normal_matrix;
+  vec4 color;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+  Object objects[];
+};
+
+// the depth pre-pass writes the depth this pass is tested against, see depth.vs
+invariant gl_Position;
 
 out vec3 vertex_global_position;
 out vec3 normal;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+out float occlusion;
+out vec4 object_color;
 
 void main() {
+  Object object = objects[object_index];
+
   // set output into gl_Position(pre defined variant)
-  gl_Position = projection * view * model * vec4(vertex_position, 1.0);
+  gl_Position = object.model_view_projection * vec4(vertex_position, 1.0);
 
-  vertex_global_position = vec3(model * vec4(vertex_position, 1.0));
-  normal = mat3(transpose(inverse(model))) * vertex_normal;
+  vertex_global_position = vec3(object.model * vec4(vertex_position, 1.0));
+  normal = object.normal_matrix * vertex_normal;
+  occlusion = vertex_occlusion;
+  object_color = object.color;
 }
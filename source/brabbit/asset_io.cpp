@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <brabbit/asset_io.hpp>
+#include <brabbit/parallel.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  namespace {
+
+    // A file read completely, waiting for a worker to run its callback.
+    struct LoadedFile {
+      std::size_t index{ 0 };
+      std::vector<char> data{};
+    };
+
+    // Files handed from the reading thread to the workers running callbacks.
+    class CompletionQueue {
+     public:
+      explicit CompletionQueue(std::size_t count) : remaining_{ count } {}
+
+     public:
+      auto push(LoadedFile file) -> void {
+        {
+          auto lock = std::scoped_lock{ mutex_ };
+          files_.push_back(std::move(file));
+        }
+        condition_.notify_one();
+      }
+
+      // Next file, false once every file of the batch has been taken.
+      auto pop(LoadedFile& file) -> bool {
+        auto lock = std::unique_lock{ mutex_ };
+        condition_.wait(lock, [this] { return !files_.empty() || remaining_ == 0; });
+        if (files_.empty()) {
+          return false;
+        }
+
+        file = std::move(files_.front());
+        files_.pop_front();
+        if (--remaining_ == 0) {
+          condition_.notify_all();
+        }
+        return true;
+      }
+
+     private:
+      std::mutex mutex_{};
+      std::condition_variable condition_{};
+      std::deque<LoadedFile> files_{};
+      std::size_t remaining_{ 0 };
+    };
+
+#if defined(__linux__)
+
+    // Reads in flight on the ring, enough to keep the queue of a NVMe drive busy.
+    constexpr auto QUEUE_DEPTH = 64u;
+
+    // Largest single read, IORING_OP_READ takes a 32 bit length.
+    constexpr auto MAX_READ = std::size_t{ 1 } << 30;
+
+    // Open a file for a whole sequential read, -1 when it is not a readable regular file.
+    auto OpenFile(const std::filesystem::path& path, std::size_t& size) -> int {
+      const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return -1;
+      }
+
+      struct stat status {};
+      if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(fd);
+        return -1;
+      }
+
+      // start readahead of the whole file now, the read itself is queued later
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+      size = static_cast<std::size_t>(status.st_size);
+      return fd;
+    }
+
+    // Blocking read of data from `done` on, the data is cleared on errors and cut at end of file.
+    auto ReadRemaining(int fd, std::vector<char>& data, std::size_t done) -> void {
+      while (done < data.size()) {
+        const auto result = ::pread(fd,
+                                    data.data() + done,
+                                    std::min(data.size() - done, MAX_READ),
+                                    static_cast<off_t>(done));
+        if (result < 0 && errno == EINTR) {
+          continue;
+        }
+        if (result < 0) {
+          data.clear();
+          return;
+        }
+        if (result == 0) {
+          break;
+        }
+        done += static_cast<std::size_t>(result);
+      }
+      data.resize(done);
+    }
+
+    // Minimal io_uring through the raw system calls, only what batched reads need.
+    class Ring {
+     public:
+      explicit Ring(unsigned entries) {
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params_));
+        if (fd_ < 0) {
+          return;
+        }
+
+        // one mapping holds both rings on kernels with IORING_FEAT_SINGLE_MMAP (5.4)
+        sq_size_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+        cq_size_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+        const auto single = (params_.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+          sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+
+        sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single ? sq_ring_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params_.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+        if (!sq_ring_ || !cq_ring_ || !sqes_) {
+          release();
+          return;
+        }
+
+        auto* sq = static_cast<char*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params_.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.array);
+
+        auto* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params_.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params_.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params_.cq_off.cqes);
+      }
+
+      ~Ring() {
+        release();
+      }
+
+      Ring(const Ring&) = delete;
+      auto operator=(const Ring&) -> Ring& = delete;
+
+     public:
+      auto isValid() const -> bool {
+        return fd_ >= 0;
+      }
+
+      // Queue a read, false when the submission queue is full.
+      auto pushRead(int fd, char* buffer, std::size_t size, std::size_t offset, std::uint64_t tag)
+          -> bool {
+        const auto head = std::atomic_ref{ *sq_head_ }.load(std::memory_order_acquire);
+        const auto tail = *sq_tail_;
+        if (tail - head >= params_.sq_entries) {
+          return false;
+        }
+
+        const auto slot = tail & sq_mask_;
+        auto& entry = sqes_[slot];
+        entry = io_uring_sqe{};
+        entry.opcode = IORING_OP_READ;
+        entry.fd = fd;
+        entry.addr = reinterpret_cast<std::uint64_t>(buffer);
+        entry.len = static_cast<std::uint32_t>(std::min(size, MAX_READ));
+        entry.off = offset;
+        entry.user_data = tag;
+        sq_array_[slot] = slot;
+
+        std::atomic_ref{ *sq_tail_ }.store(tail + 1, std::memory_order_release);
+        ++queued_;
+        return true;
+      }
+
+      // Submit the queued reads and wait until at least `wait` have completed.
+      auto submit(unsigned wait) -> bool {
+        while (true) {
+          const auto flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0u;
+          const auto result = ::syscall(__NR_io_uring_enter, fd_, queued_, wait, flags, nullptr, 0);
+          if (result >= 0) {
+            queued_ -= std::min(queued_, static_cast<unsigned>(result));
+            return true;
+          }
+          if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return false;
+          }
+        }
+      }
+
+      // function: (std::uint64_t tag, int result) for every completion, result as read(2) or -errno
+      template <typename _Function>
+      auto reap(_Function&& function) -> void {
+        auto head = *cq_head_;
+        const auto tail = std::atomic_ref{ *cq_tail_ }.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+          const auto& entry = cqes_[head & cq_mask_];
+          const auto tag = entry.user_data;
+          const auto result = entry.res;
+          std::atomic_ref{ *cq_head_ }.store(head + 1, std::memory_order_release);
+          function(tag, result);
+        }
+      }
+
+     private:
+      auto map(std::size_t size, std::uint64_t offset) const -> void* {
+        auto* address = ::mmap(nullptr,
+                               size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE,
+                               fd_,
+                               static_cast<off_t>(offset));
+        return address == MAP_FAILED ? nullptr : address;
+      }
+
+      auto release() -> void {
+        if (sqes_) {
+          ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ && cq_ring_ != sq_ring_) {
+          ::munmap(cq_ring_, cq_size_);
+        }
+        if (sq_ring_) {
+          ::munmap(sq_ring_, sq_size_);
+        }
+        if (fd_ >= 0) {
+          ::close(fd_);
+        }
+        sqes_ = nullptr;
+        sq_ring_ = cq_ring_ = nullptr;
+        fd_ = -1;
+      }
+
+     private:
+      int fd_{ -1 };
+      io_uring_params params_{};
+      unsigned queued_{ 0 };
+
+      void* sq_ring_{ nullptr };
+      void* cq_ring_{ nullptr };
+      io_uring_sqe* sqes_{ nullptr };
+      std::size_t sq_size_{ 0 };
+      std::size_t cq_size_{ 0 };
+      std::size_t sqes_size_{ 0 };
+
+      unsigned* sq_head_{ nullptr };
+      unsigned* sq_tail_{ nullptr };
+      unsigned* sq_array_{ nullptr };
+      unsigned sq_mask_{ 0 };
+      unsigned* cq_head_{ nullptr };
+      unsigned* cq_tail_{ nullptr };
+      io_uring_cqe* cqes_{ nullptr };
+      unsigned cq_mask_{ 0 };
+    };
+
+    // One file being read through the ring.
+    struct Transfer {
+      int fd{ -1 };
+      std::size_t index{ 0 };
+      std::size_t done{ 0 };
+      std::vector<char> data{};
+    };
+
+    // Keep up to QUEUE_DEPTH reads in flight and push every finished file to the queue. Reads the
+    // ring can not do, or all of them once the ring fails, finish with blocking reads.
+    auto ReadThroughRing(Ring& ring,
+                         std::span<const std::filesystem::path> paths,
+                         CompletionQueue& completions) -> void {
+      auto transfers = std::vector<Transfer>(QUEUE_DEPTH);
+      auto free_slots = std::vector<std::uint64_t>{};
+      for (auto slot = QUEUE_DEPTH; slot > 0; --slot) {
+        free_slots.push_back(slot - 1);
+      }
+
+      const auto finish = [&](std::uint64_t slot) {
+        auto& transfer = transfers[slot];
+        ::close(transfer.fd);
+        completions.push({ transfer.index, std::move(transfer.data) });
+        transfer = Transfer{};
+        free_slots.push_back(slot);
+      };
+
+      const auto queue = [&](std::uint64_t slot) {
+        auto& transfer = transfers[slot];
+        return ring.pushRead(transfer.fd,
+                             transfer.data.data() + transfer.done,
+                             transfer.data.size() - transfer.done,
+                             transfer.done,
+                             slot);
+      };
+
+      auto next = std::size_t{ 0 };
+      auto failed = false;
+      while (!failed && (next < paths.size() || free_slots.size() < QUEUE_DEPTH)) {
+        while (next < paths.size() && !free_slots.empty()) {
+          const auto index = next++;
+          auto size = std::size_t{ 0 };
+          const auto fd = OpenFile(paths[index], size);
+          if (fd < 0 || size == 0) {
+            if (fd >= 0) {
+              ::close(fd);
+            }
+            completions.push({ index, {} });
+            continue;
+          }
+
+          const auto slot = free_slots.back();
+          free_slots.pop_back();
+          transfers[slot] = Transfer{ fd, index, 0, std::vector<char>(size) };
+          queue(slot);
+        }
+
+        const auto in_flight = free_slots.size() < QUEUE_DEPTH;
+        if (in_flight && !ring.submit(1)) {
+          failed = true;
+          break;
+        }
+
+        ring.reap([&](std::uint64_t slot, int result) {
+          auto& transfer = transfers[slot];
+          if (result == -EAGAIN || result == -EINTR) {
+            queue(slot);
+            return;
+          }
+
+          if (result < 0) {
+            // old kernels reject IORING_OP_READ, a real error fails the blocking read as well
+            ReadRemaining(transfer.fd, transfer.data, transfer.done);
+            finish(slot);
+            return;
+          }
+
+          transfer.done += static_cast<std::size_t>(result);
+          if (result > 0 && transfer.done < transfer.data.size()) {
+            queue(slot);
+            return;
+          }
+
+          transfer.data.resize(transfer.done);
+          finish(slot);
+        });
+      }
+
+      if (!failed) {
+        return;
+      }
+
+      for (auto slot = std::uint64_t{ 0 }; slot < QUEUE_DEPTH; ++slot) {
+        if (transfers[slot].fd >= 0) {
+          ReadRemaining(transfers[slot].fd, transfers[slot].data, transfers[slot].done);
+          finish(slot);
+        }
+      }
+      for (; next < paths.size(); ++next) {
+        completions.push({ next, ReadFile(paths[next]) });
+      }
+    }
+
+#endif
+
+  }  // namespace
+
+  auto GetResourceRoot() -> const std::filesystem::path& {
+    static const auto Root = std::filesystem::current_path() / "resource"sv;
+    return Root;
+  }
+
+  auto ReadFile(const std::filesystem::path& path) -> std::vector<char> {
+#if defined(__linux__)
+    auto size = std::size_t{ 0 };
+    const auto fd = OpenFile(path, size);
+    if (fd < 0) {
+      return {};
+    }
+
+    auto data = std::vector<char>(size);
+    ReadRemaining(fd, data, 0);
+    ::close(fd);
+    return data;
+#else
+    auto file = std::ifstream{ path, std::ios::binary | std::ios::ate };
+    if (!file) {
+      return {};
+    }
+
+    auto data = std::vector<char>(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+      return {};
+    }
+    return data;
+#endif
+  }
+
+  auto ReadFiles(std::span<const std::filesystem::path> paths, const FileCallback& callback)
+      -> void {
+    const auto workers = GetParallelChunkCount(paths.size(), 1);
+
+#if defined(__linux__)
+    auto ring = Ring{ QUEUE_DEPTH };
+    if (ring.isValid()) {
+      // one thread drives the ring, the workers parse what it delivers
+      auto completions = CompletionQueue{ paths.size() };
+      auto reader = std::jthread{ [&] { ReadThroughRing(ring, paths, completions); } };
+
+      ParallelFor(workers, 1, [&](auto, auto, auto) {
+        auto file = LoadedFile{};
+        while (completions.pop(file)) {
+          callback(file.index, file.data);
+        }
+      });
+      return;
+    }
+#endif
+
+    auto next = std::atomic<std::size_t>{ 0 };
+    ParallelFor(workers, 1, [&](auto, auto, auto) {
+      for (auto index = next++; index < paths.size(); index = next++) {
+        const auto data = ReadFile(paths[index]);
+        callback(index, data);
+      }
+    });
+  }
+
+}  // namespace brabbit
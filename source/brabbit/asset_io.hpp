@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace brabbit {
+
+  // Directory holding the model and shader folders, resolved from the working directory once.
+  auto GetResourceRoot() -> const std::filesystem::path&;
+
+  // Whole contents of a file, empty when it is missing or unreadable.
+  auto ReadFile(const std::filesystem::path& path) -> std::vector<char>;
+
+  // function: (std::size_t index, std::span<const char> data), data is empty for unreadable files
+  using FileCallback = std::function<void(std::size_t, std::span<const char>)>;
+
+  // Read a batch of files and hand each one to callback as soon as it arrives, in completion order.
+  // On Linux the reads are queued on io_uring, many at once so cold loads keep the disk busy,
+  // elsewhere or when the kernel refuses a ring worker threads do blocking reads.
+  // Callbacks run concurrently on worker threads, ReadFiles returns after the last one.
+  auto ReadFiles(std::span<const std::filesystem::path> paths, const FileCallback& callback)
+      -> void;
+
+}  // namespace brabbit
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#include <brabbit/bvh.hpp>
+#include <brabbit/parallel.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto BIN_COUNT = 16;
+    constexpr auto MAX_LEAF_SIZE = 8u;
+    constexpr auto MAX_DEPTH = 56;
+    constexpr auto TRAVERSAL_COST = 1.0f;
+
+    // Ranges bigger than this are binned in chunks and built as separate tasks.
+    constexpr auto PARALLEL_THRESHOLD = 1u << 14;
+
+    struct Bin {
+      Aabb bounds{};
+      std::uint32_t count{ 0 };
+    };
+
+    using Bins = std::array<std::array<Bin, BIN_COUNT>, 3>;
+
+    // primitive data is partitioned in place so every pass reads memory sequentially
+    struct Reference {
+      Aabb bounds{};
+      glm::vec3 center{};
+      std::uint32_t primitive{ 0 };
+    };
+
+    struct Split {
+      int axis{ -1 };
+      int bin{ 0 };
+      float cost{ std::numeric_limits<float>::infinity() };
+    };
+
+    class Builder {
+     public:
+      explicit Builder(std::span<const Aabb> bounds,
+                       std::vector<Bvh::Node>& nodes,
+                       std::vector<std::uint32_t>& primitives)
+          : nodes_{ nodes }, primitives_{ primitives } {
+        references_.resize(bounds.size());
+        ParallelFor(bounds.size(), PARALLEL_THRESHOLD, [this, bounds](auto, auto begin, auto end) {
+          for (auto i = begin; i < end; ++i) {
+            references_[i] = { bounds[i], bounds[i].getCenter(), static_cast<std::uint32_t>(i) };
+          }
+        });
+
+        const auto workers = std::max(1u, std::thread::hardware_concurrency());
+        task_depth_ = 1;
+        while ((1u << task_depth_) < workers * 2) {
+          ++task_depth_;
+        }
+      }
+
+      auto build() -> void {
+        const auto count = static_cast<std::uint32_t>(references_.size());
+
+        // a binary tree over n leaves never needs more than 2n - 1 nodes
+        nodes_.resize(std::max(1u, 2 * count - 1));
+        node_count_ = 1;
+        build(0, 0, count, 0);
+        nodes_.resize(node_count_);
+        nodes_.shrink_to_fit();
+
+        primitives_.resize(count);
+        for (auto i = 0u; i < count; ++i) {
+          primitives_[i] = references_[i].primitive;
+        }
+      }
+
+     private:
+      auto build(std::uint32_t index, std::uint32_t begin, std::uint32_t end, int depth) -> void {
+        auto bounds = Aabb{};
+        auto center_bounds = Aabb{};
+        computeBounds(begin, end, bounds, center_bounds);
+
+        auto& node = nodes_[index];
+        node.min = bounds.min;
+        node.max = bounds.max;
+
+        const auto count = end - begin;
+        const auto make_leaf = [&node, begin, count] {
+          node.index = begin;
+          node.count = count;
+        };
+
+        if (count <= 2 || depth >= MAX_DEPTH) {
+          make_leaf();
+          return;
+        }
+
+        auto middle = begin;
+        const auto split = findSplit(begin, end, bounds, center_bounds);
+        if (split.axis >= 0) {
+          if (split.cost >= static_cast<float>(count) && count <= MAX_LEAF_SIZE) {
+            make_leaf();
+            return;
+          }
+
+          const auto axis = split.axis;
+          const auto minimum = center_bounds.min[axis];
+          const auto scale = BIN_COUNT / (center_bounds.max[axis] - minimum);
+          auto* first = references_.data() + begin;
+          auto* last = references_.data() + end;
+          auto* pivot = std::partition(first, last, [&](const Reference& reference) {
+            const auto bin = static_cast<int>((reference.center[axis] - minimum) * scale);
+            return std::min(bin, BIN_COUNT - 1) < split.bin;
+          });
+          middle = begin + static_cast<std::uint32_t>(pivot - first);
+        }
+
+        // degenerate centroids, fall back to a median split on the widest axis
+        if (middle == begin || middle == end) {
+          if (count <= MAX_LEAF_SIZE) {
+            make_leaf();
+            return;
+          }
+
+          const auto extent = center_bounds.getExtent();
+          const auto axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2)
+                                                : (extent.y > extent.z ? 1 : 2);
+          middle = begin + count / 2;
+          std::nth_element(references_.begin() + begin,
+                           references_.begin() + middle,
+                           references_.begin() + end,
+                           [axis](const Reference& lhs, const Reference& rhs) {
+                             return lhs.center[axis] < rhs.center[axis];
+                           });
+        }
+
+        const auto left = node_count_.fetch_add(2);
+        node.index = left;
+        node.count = 0;
+
+        if (count > PARALLEL_THRESHOLD && depth < task_depth_) {
+          auto task = std::async(std::launch::async, [this, left, begin, middle, depth] {
+            build(left, begin, middle, depth + 1);
+          });
+          build(left + 1, middle, end, depth + 1);
+          task.get();
+          return;
+        }
+
+        build(left, begin, middle, depth + 1);
+        build(left + 1, middle, end, depth + 1);
+      }
+
+      auto computeBounds(std::uint32_t begin,
+                         std::uint32_t end,
+                         Aabb& bounds,
+                         Aabb& center_bounds) const -> void {
+        const auto count = end - begin;
+        if (count <= PARALLEL_THRESHOLD) {
+          for (auto i = begin; i < end; ++i) {
+            bounds.expand(references_[i].bounds);
+            center_bounds.expand(references_[i].center);
+          }
+          return;
+        }
+
+        auto partials = std::vector<std::pair<Aabb, Aabb>>(
+            GetParallelChunkCount(count, PARALLEL_THRESHOLD));
+        ParallelFor(count, PARALLEL_THRESHOLD, [&](auto chunk, auto first, auto last) {
+          auto& [chunk_bounds, chunk_centers] = partials[chunk];
+          for (auto i = begin + first; i < begin + last; ++i) {
+            chunk_bounds.expand(references_[i].bounds);
+            chunk_centers.expand(references_[i].center);
+          }
+        });
+
+        for (const auto& [chunk_bounds, chunk_centers] : partials) {
+          bounds.expand(chunk_bounds);
+          center_bounds.expand(chunk_centers);
+        }
+      }
+
+      auto fillBins(std::uint32_t begin,
+                    std::uint32_t end,
+                    const Aabb& center_bounds,
+                    Bins& bins) const -> void {
+        const auto extent = center_bounds.getExtent();
+        const auto scale = glm::vec3{
+          extent.x > 0.0f ? BIN_COUNT / extent.x : 0.0f,
+          extent.y > 0.0f ? BIN_COUNT / extent.y : 0.0f,
+          extent.z > 0.0f ? BIN_COUNT / extent.z : 0.0f,
+        };
+
+        for (auto i = begin; i < end; ++i) {
+          const auto& reference = references_[i];
+          const auto offset = (reference.center - center_bounds.min) * scale;
+          for (auto axis = 0; axis < 3; ++axis) {
+            const auto index = std::min(static_cast<int>(offset[axis]), BIN_COUNT - 1);
+            auto& bin = bins[axis][index];
+            bin.bounds.expand(reference.bounds);
+            ++bin.count;
+          }
+        }
+      }
+
+      auto findSplit(std::uint32_t begin,
+                     std::uint32_t end,
+                     const Aabb& bounds,
+                     const Aabb& center_bounds) const -> Split {
+        const auto count = end - begin;
+
+        auto bins = Bins{};
+        if (count <= PARALLEL_THRESHOLD) {
+          fillBins(begin, end, center_bounds, bins);
+        } else {
+          auto partials = std::vector<Bins>(GetParallelChunkCount(count, PARALLEL_THRESHOLD));
+          ParallelFor(count, PARALLEL_THRESHOLD, [&](auto chunk, auto first, auto last) {
+            fillBins(begin + first, begin + last, center_bounds, partials[chunk]);
+          });
+
+          for (const auto& partial : partials) {
+            for (auto axis = 0; axis < 3; ++axis) {
+              for (auto index = 0; index < BIN_COUNT; ++index) {
+                bins[axis][index].bounds.expand(partial[axis][index].bounds);
+                bins[axis][index].count += partial[axis][index].count;
+              }
+            }
+          }
+        }
+
+        const auto area = std::max(bounds.getSurfaceArea(), std::numeric_limits<float>::min());
+        const auto extent = center_bounds.getExtent();
+
+        auto best = Split{};
+        for (auto axis = 0; axis < 3; ++axis) {
+          if (extent[axis] <= 0.0f) {
+            continue;
+          }
+
+          // sweep from the right to get the cost of every right hand side
+          auto right_areas = std::array<float, BIN_COUNT>{};
+          auto right_counts = std::array<std::uint32_t, BIN_COUNT>{};
+          auto right_bounds = Aabb{};
+          auto right_count = 0u;
+          for (auto index = BIN_COUNT - 1; index > 0; --index) {
+            right_bounds.expand(bins[axis][index].bounds);
+            right_count += bins[axis][index].count;
+            right_areas[index] = right_bounds.getSurfaceArea();
+            right_counts[index] = right_count;
+          }
+
+          auto left_bounds = Aabb{};
+          auto left_count = 0u;
+          for (auto index = 1; index < BIN_COUNT; ++index) {
+            left_bounds.expand(bins[axis][index - 1].bounds);
+            left_count += bins[axis][index - 1].count;
+            if (left_count == 0 || right_counts[index] == 0) {
+              continue;
+            }
+
+            const auto cost = TRAVERSAL_COST + (left_count * left_bounds.getSurfaceArea() +
+                                                right_counts[index] * right_areas[index]) / area;
+            if (cost < best.cost) {
+              best = { axis, index, cost };
+            }
+          }
+        }
+
+        return best;
+      }
+
+     private:
+      std::vector<Reference> references_{};
+      std::vector<Bvh::Node>& nodes_;
+      std::vector<std::uint32_t>& primitives_;
+      std::atomic<std::uint32_t> node_count_{ 0 };
+      int task_depth_{ 1 };
+    };
+
+  }  // namespace
+
+  auto Aabb::isEmpty() const -> bool {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+  }
+
+  auto Aabb::getCenter() const -> glm::vec3 {
+    return (min + max) * 0.5f;
+  }
+
+  auto Aabb::getExtent() const -> glm::vec3 {
+    return isEmpty() ? glm::vec3{ 0.0f } : max - min;
+  }
+
+  auto Aabb::getSurfaceArea() const -> float {
+    const auto extent = getExtent();
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+  }
+
+  auto Aabb::transform(const glm::mat4& matrix) const -> Aabb {
+    if (isEmpty()) {
+      return {};
+    }
+
+    // Arvo's method: accumulate the min / max contribution of every matrix element
+    auto result = Aabb{ glm::vec3{ matrix[3] }, glm::vec3{ matrix[3] } };
+    for (auto column = 0; column < 3; ++column) {
+      for (auto row = 0; row < 3; ++row) {
+        const auto a = matrix[column][row] * min[column];
+        const auto b = matrix[column][row] * max[column];
+        result.min[row] += std::min(a, b);
+        result.max[row] += std::max(a, b);
+      }
+    }
+    return result;
+  }
+
+  auto Aabb::intersect(const Ray& ray, const glm::vec3& inverse_direction, float max_distance) const
+      -> float {
+    const auto t0 = (min - ray.origin) * inverse_direction;
+    const auto t1 = (max - ray.origin) * inverse_direction;
+    const auto near = glm::min(t0, t1);
+    const auto far = glm::max(t0, t1);
+    const auto enter = std::max({ near.x, near.y, near.z, 0.0f });
+    const auto leave = std::min({ far.x, far.y, far.z, max_distance });
+    return enter <= leave ? enter : std::numeric_limits<float>::infinity();
+  }
+
+  auto IntersectTriangle(const Ray& ray,
+                         const glm::vec3& a,
+                         const glm::vec3& b,
+                         const glm::vec3& c,
+                         RayHit& hit) -> bool {
+    constexpr auto EPSILON = 1e-9f;
+
+    const auto edge1 = b - a;
+    const auto edge2 = c - a;
+    const auto p = glm::cross(ray.direction, edge2);
+    const auto determinant = glm::dot(edge1, p);
+    if (std::abs(determinant) < EPSILON) {
+      return false;
+    }
+
+    const auto inverse_determinant = 1.0f / determinant;
+    const auto s = ray.origin - a;
+    const auto u = glm::dot(s, p) * inverse_determinant;
+    if (u < 0.0f || u > 1.0f) {
+      return false;
+    }
+
+    const auto q = glm::cross(s, edge1);
+    const auto v = glm::dot(ray.direction, q) * inverse_determinant;
+    if (v < 0.0f || u + v > 1.0f) {
+      return false;
+    }
+
+    const auto distance = glm::dot(edge2, q) * inverse_determinant;
+    if (distance < 0.0f || distance >= hit.distance) {
+      return false;
+    }
+
+    hit.distance = distance;
+    hit.barycentric = { u, v };
+    return true;
+  }
+
+  auto ClosestPointOnTriangle(const glm::vec3& p,
+                              const glm::vec3& a,
+                              const glm::vec3& b,
+                              const glm::vec3& c) -> glm::vec3 {
+    const auto ab = b - a;
+    const auto ac = c - a;
+
+    const auto ap = p - a;
+    const auto d1 = glm::dot(ab, ap);
+    const auto d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+      return a;
+    }
+
+    const auto bp = p - b;
+    const auto d3 = glm::dot(ab, bp);
+    const auto d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+      return b;
+    }
+
+    const auto vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+      return a + ab * (d1 / (d1 - d3));
+    }
+
+    const auto cp = p - c;
+    const auto d5 = glm::dot(ab, cp);
+    const auto d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+      return c;
+    }
+
+    const auto vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+      return a + ac * (d2 / (d2 - d6));
+    }
+
+    const auto va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+      return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const auto denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+  }
+
+  Bvh::Bvh() = default;
+
+  Bvh::Bvh(std::span<const Aabb> bounds) {
+    if (bounds.empty()) {
+      return;
+    }
+
+    auto builder = Builder{ bounds, nodes_, primitives_ };
+    builder.build();
+  }
+
+  auto Bvh::isEmpty() const -> bool {
+    return nodes_.empty();
+  }
+
+  auto Bvh::getBounds() const -> Aabb {
+    if (nodes_.empty()) {
+      return {};
+    }
+
+    return { nodes_.front().min, nodes_.front().max };
+  }
+
+  auto Bvh::getNodes() const -> const std::vector<Node>& {
+    return nodes_;
+  }
+
+  auto Bvh::getPrimitives() const -> const std::vector<std::uint32_t>& {
+    return primitives_;
+  }
+
+  auto Bvh::refit(std::span<const Aabb> bounds) -> void {
+    if (bounds.size() != primitives_.size()) {
+      return;
+    }
+
+    // children are always allocated after their parent, so a reverse walk visits them first
+    for (auto index = nodes_.size(); index-- > 0;) {
+      auto& node = nodes_[index];
+      auto box = Aabb{};
+      if (node.count > 0) {
+        for (auto i = node.index; i < node.index + node.count; ++i) {
+          box.expand(bounds[primitives_[i]]);
+        }
+      } else {
+        box.expand(Aabb{ nodes_[node.index].min, nodes_[node.index].max });
+        box.expand(Aabb{ nodes_[node.index + 1].min, nodes_[node.index + 1].max });
+      }
+      node.min = box.min;
+      node.max = box.max;
+    }
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  constexpr auto INVALID_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+  struct Ray {
+    glm::vec3 origin{ 0.0f, 0.0f, 0.0f };
+    glm::vec3 direction{ 0.0f, 0.0f, -1.0f };
+  };
+
+  struct RayHit {
+    float         distance{ std::numeric_limits<float>::infinity() };
+    std::uint32_t primitive{ INVALID_INDEX };
+    glm::vec2     barycentric{ 0.0f, 0.0f };
+  };
+
+  struct ClosestPoint {
+    float         distance{ std::numeric_limits<float>::infinity() };
+    std::uint32_t primitive{ INVALID_INDEX };
+    glm::vec3     position{ 0.0f, 0.0f, 0.0f };
+  };
+
+  struct Aabb {
+    glm::vec3 min{ std::numeric_limits<float>::infinity() };
+    glm::vec3 max{ -std::numeric_limits<float>::infinity() };
+
+    auto isEmpty() const -> bool;
+    auto getCenter() const -> glm::vec3;
+    auto getExtent() const -> glm::vec3;
+    auto getSurfaceArea() const -> float;
+
+    // hot in BVH builds, kept inline
+    auto expand(const glm::vec3& point) -> void {
+      min = glm::min(min, point);
+      max = glm::max(max, point);
+    }
+
+    auto expand(const Aabb& other) -> void {
+      min = glm::min(min, other.min);
+      max = glm::max(max, other.max);
+    }
+
+    // Squared distance from a point to the box, 0 inside.
+    auto getDistanceSquared(const glm::vec3& point) const -> float {
+      const auto delta = glm::max(glm::max(min - point, point - max), glm::vec3{ 0.0f });
+      return glm::dot(delta, delta);
+    }
+
+    // Bounds of this box after an affine transform.
+    auto transform(const glm::mat4& matrix) const -> Aabb;
+
+    // Entry distance of the ray into this box, +inf when it misses or enters beyond max_distance.
+    auto intersect(const Ray& ray, const glm::vec3& inverse_direction, float max_distance) const
+        -> float;
+  };
+
+  // Moller-Trumbore ray / triangle test, fills distance and barycentric of hit when closer.
+  auto IntersectTriangle(const Ray& ray,
+                         const glm::vec3& a,
+                         const glm::vec3& b,
+                         const glm::vec3& c,
+                         RayHit& hit) -> bool;
+
+  // Closest point of triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5).
+  auto ClosestPointOnTriangle(const glm::vec3& p,
+                              const glm::vec3& a,
+                              const glm::vec3& b,
+                              const glm::vec3& c) -> glm::vec3;
+
+  // Bounding volume hierarchy over arbitrary primitives given by their bounds.
+  // Built with binned SAH, the upper levels are built on worker threads.
+  class Bvh {
+   public:
+    struct Node {
+      glm::vec3     min{};
+      std::uint32_t index{ 0 };  // first primitive for leaves, left child for inner nodes
+      glm::vec3     max{};
+      std::uint32_t count{ 0 };  // primitive count of leaves, 0 for inner nodes
+    };
+
+   public:
+    explicit Bvh();
+    explicit Bvh(std::span<const Aabb> bounds);
+    Bvh(Bvh&& other) = default;
+    virtual ~Bvh() = default;
+
+    auto operator=(Bvh&& other) -> Bvh& = default;
+
+   public:
+    auto isEmpty() const -> bool;
+    auto getBounds() const -> Aabb;
+
+    auto getNodes() const -> const std::vector<Node>&;
+    auto getPrimitives() const -> const std::vector<std::uint32_t>&;
+
+    // Recompute node bounds for moved primitives and keep the tree, the count must not change.
+    // Much cheaper than a rebuild, the tree only degrades when primitives move a lot.
+    auto refit(std::span<const Aabb> bounds) -> void;
+
+    // Visit primitives whose node bounds the ray enters, nearest node first.
+    // intersect: (std::uint32_t primitive, float& max_distance) -> void,
+    // shrink max_distance on a hit to prune the rest of the traversal.
+    template <typename _Function>
+    auto traverse(const Ray& ray, float max_distance, _Function&& intersect) const -> void;
+
+    // Visit primitives whose node bounds are closer to the point than max_distance, nearest first.
+    // visit: (std::uint32_t primitive, float& max_distance_squared) -> void,
+    // shrink max_distance_squared when a closer primitive is found, 0 stops the query.
+    template <typename _Function>
+    auto traverseNearest(const glm::vec3& point, float max_distance, _Function&& visit) const
+        -> void;
+
+   private:
+    std::vector<Node> nodes_{};
+    std::vector<std::uint32_t> primitives_{};
+  };
+
+  template <typename _Function>
+  auto Bvh::traverse(const Ray& ray, float max_distance, _Function&& intersect) const -> void {
+    if (nodes_.empty()) {
+      return;
+    }
+
+    // Aabb::intersect already clamps to max_distance, anything finite is a hit
+    constexpr auto MISS = std::numeric_limits<float>::infinity();
+
+    // keep the inverse finite, 0 * inf in the slab test would give NaN for rays on a slab plane
+    constexpr auto TINY = 1e-30f;
+    const auto inverse_direction = 1.0f / glm::vec3{
+      std::abs(ray.direction.x) > TINY ? ray.direction.x : std::copysign(TINY, ray.direction.x),
+      std::abs(ray.direction.y) > TINY ? ray.direction.y : std::copysign(TINY, ray.direction.y),
+      std::abs(ray.direction.z) > TINY ? ray.direction.z : std::copysign(TINY, ray.direction.z),
+    };
+    const auto node_bounds = [this](std::uint32_t index) {
+      const auto& node = nodes_[index];
+      return Aabb{ node.min, node.max };
+    };
+
+    if (node_bounds(0).intersect(ray, inverse_direction, max_distance) == MISS) {
+      return;
+    }
+
+    auto stack = std::array<std::uint32_t, 64>{};
+    auto top = std::size_t{ 0 };
+    stack[top++] = 0;
+
+    while (top > 0) {
+      const auto& node = nodes_[stack[--top]];
+
+      if (node.count > 0) {
+        for (auto i = node.index; i < node.index + node.count; ++i) {
+          intersect(primitives_[i], max_distance);
+        }
+        continue;
+      }
+
+      auto near = node.index;
+      auto far = node.index + 1;
+      auto near_distance = node_bounds(near).intersect(ray, inverse_direction, max_distance);
+      auto far_distance = node_bounds(far).intersect(ray, inverse_direction, max_distance);
+      if (far_distance < near_distance) {
+        std::swap(near, far);
+        std::swap(near_distance, far_distance);
+      }
+
+      // push the far child first so the near one is popped next
+      if (far_distance != MISS) {
+        stack[top++] = far;
+      }
+      if (near_distance != MISS) {
+        stack[top++] = near;
+      }
+    }
+  }
+
+  template <typename _Function>
+  auto Bvh::traverseNearest(const glm::vec3& point, float max_distance, _Function&& visit) const
+      -> void {
+    if (nodes_.empty()) {
+      return;
+    }
+
+    const auto node_distance = [this, &point](std::uint32_t index) {
+      const auto& node = nodes_[index];
+      return Aabb{ node.min, node.max }.getDistanceSquared(point);
+    };
+
+    auto max_distance_squared = max_distance * max_distance;
+
+    // remember the distance of every pushed node, it may be pruned by then
+    auto stack = std::array<std::pair<std::uint32_t, float>, 64>{};
+    auto top = std::size_t{ 0 };
+    stack[top++] = { 0, node_distance(0) };
+
+    while (top > 0) {
+      const auto [index, distance] = stack[--top];
+      if (distance >= max_distance_squared) {
+        continue;
+      }
+
+      const auto& node = nodes_[index];
+      if (node.count > 0) {
+        for (auto i = node.index; i < node.index + node.count; ++i) {
+          visit(primitives_[i], max_distance_squared);
+        }
+        continue;
+      }
+
+      auto near = std::pair{ node.index, node_distance(node.index) };
+      auto far = std::pair{ node.index + 1, node_distance(node.index + 1) };
+      if (far.second < near.second) {
+        std::swap(near, far);
+      }
+
+      if (far.second < max_distance_squared) {
+        stack[top++] = far;
+      }
+      if (near.second < max_distance_squared) {
+        stack[top++] = near;
+      }
+    }
+  }
+
+}  // namespace brabbit
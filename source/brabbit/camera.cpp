@@ -155,6 +155,21 @@ namespace brabbit {
     return projection_;
   }
 
+  auto Camera::generateRay(const glm::vec2& screen_position) const -> Ray {
+    const auto ndc = glm::vec2{
+      2.0f * screen_position.x / width_ - 1.0f,
+      1.0f - 2.0f * screen_position.y / height_,
+    };
+
+    const auto inverse = glm::inverse(projection_ * view_);
+    auto near = inverse * glm::vec4{ ndc, -1.0f, 1.0f };
+    auto far = inverse * glm::vec4{ ndc, 1.0f, 1.0f };
+    near /= near.w;
+    far /= far.w;
+
+    return { position_, glm::normalize(glm::vec3{ far } - glm::vec3{ near }) };
+  }
+
   auto Camera::getSpeed() const -> float {
     return speed_;
   }
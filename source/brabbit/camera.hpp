@@ -4,6 +4,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <brabbit/bvh.hpp>
+
 namespace brabbit {
 
   class Camera {
@@ -59,6 +61,9 @@ namespace brabbit {
 
     auto getProjection() const -> const glm::mat4&;
 
+    // World space ray through a point of the viewport, in pixels from the top left corner.
+    auto generateRay(const glm::vec2& screen_position) const -> Ray;
+
    public:
     auto getSpeed() const -> float;
     auto setSpeed(float speed) -> void;
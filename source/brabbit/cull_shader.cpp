@@ -0,0 +1,27 @@
+#include <brabbit/cull_shader.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  CullShader::CullShader() : Shader{ "cull.cs"sv } {}
+
+  CullShader::~CullShader() = default;
+
+  auto CullShader::setInstanceCount(GLuint count) const -> void {
+    setUint("instance_count"sv, count);
+  }
+
+  auto CullShader::setOcclusion(bool occlusion) const -> void {
+    setInt("occlusion"sv, occlusion ? 1 : 0);
+  }
+
+  auto CullShader::setDepthPyramid(GLint unit) const -> void {
+    setInt("depth_pyramid"sv, unit);
+  }
+
+  auto CullShader::setPreviousViewProjection(const glm::mat4& view_projection) const -> void {
+    setMat4("previous_view_projection"sv, view_projection);
+  }
+
+}  // namespace brabbit
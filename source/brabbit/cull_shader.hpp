@@ -0,0 +1,22 @@
+#pragma once
+
+#include <brabbit/shader.hpp>
+
+namespace brabbit {
+
+  // Frustum and depth pyramid test of every instance, see GpuCuller for the buffers it reads.
+  class CullShader : public Shader {
+   public:
+    explicit CullShader();
+    virtual ~CullShader() override;
+
+   public:
+    auto setInstanceCount(GLuint count) const -> void;
+
+    // Occlusion against the pyramid of a previous frame, drawn with previous_view_projection.
+    auto setOcclusion(bool occlusion) const -> void;
+    auto setDepthPyramid(GLint unit) const -> void;
+    auto setPreviousViewProjection(const glm::mat4& view_projection) const -> void;
+  };
+
+}  // namespace brabbit
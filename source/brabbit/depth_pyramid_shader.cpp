@@ -0,0 +1,19 @@
+#include <brabbit/depth_pyramid_shader.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  DepthPyramidShader::DepthPyramidShader() : Shader{ "depth_pyramid.cs"sv } {}
+
+  DepthPyramidShader::~DepthPyramidShader() = default;
+
+  auto DepthPyramidShader::setSource(GLint unit) const -> void {
+    setInt("source"sv, unit);
+  }
+
+  auto DepthPyramidShader::setSourceLevel(GLint level) const -> void {
+    setInt("source_level"sv, level);
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <brabbit/shader.hpp>
+
+namespace brabbit {
+
+  // Writes one level of the depth pyramid from the level before it, or from the depth buffer.
+  class DepthPyramidShader : public Shader {
+   public:
+    explicit DepthPyramidShader();
+    virtual ~DepthPyramidShader() override;
+
+   public:
+    auto setSource(GLint unit) const -> void;
+    auto setSourceLevel(GLint level) const -> void;
+  };
+
+}  // namespace brabbit
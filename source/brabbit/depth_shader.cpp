@@ -0,0 +1,11 @@
+#include <brabbit/depth_shader.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  DepthShader::DepthShader() : Shader{ "depth.vs"sv, "depth.fs"sv } {}
+
+  DepthShader::~DepthShader() = default;
+
+}  // namespace brabbit
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <brabbit/shader.hpp>
+
+namespace brabbit {
+
+  // Positions of arena geometry into the depth buffer only, for the depth pre-pass. Reads the
+  // bound ObjectBuffer like PhongShader and places vertices exactly where it does.
+  class DepthShader : public Shader {
+   public:
+    explicit DepthShader();
+    virtual ~DepthShader() override;
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace brabbit {
+
+  struct Range {
+    std::size_t first{ 0 };
+    std::size_t count{ 0 };
+
+    auto end() const -> std::size_t {
+      return first + count;
+    }
+  };
+
+  // Sorted, coalesced element ranges waiting for an upload.
+  // Ranges closer than `gap` elements are joined: one bigger upload is cheaper than many calls.
+  class DirtyRanges {
+   public:
+    explicit DirtyRanges(std::size_t gap = 64) : gap_{ gap } {}
+
+   public:
+    auto isEmpty() const -> bool {
+      return ranges_.empty();
+    }
+
+    auto getRanges() const -> const std::vector<Range>& {
+      return ranges_;
+    }
+
+    auto clear() -> void {
+      ranges_.clear();
+    }
+
+    auto add(std::size_t first, std::size_t count) -> void {
+      if (count == 0) {
+        return;
+      }
+
+      // first range that could touch the new one, everything before it ends too early
+      auto begin = std::lower_bound(
+          ranges_.begin(), ranges_.end(), first, [this](const Range& range, std::size_t value) {
+            return range.end() + gap_ < value;
+          });
+
+      auto merged = Range{ first, count };
+      auto end = begin;
+      while (end != ranges_.end() && end->first <= merged.end() + gap_) {
+        const auto last = std::max(merged.end(), end->end());
+        merged.first = std::min(merged.first, end->first);
+        merged.count = last - merged.first;
+        ++end;
+      }
+
+      begin = ranges_.erase(begin, end);
+      ranges_.insert(begin, merged);
+    }
+
+    auto add(const DirtyRanges& other) -> void {
+      for (const auto& range : other.ranges_) {
+        add(range.first, range.count);
+      }
+    }
+
+    // Drop everything at or beyond `size`, after the data shrank.
+    auto clamp(std::size_t size) -> void {
+      std::erase_if(ranges_, [size](const Range& range) { return range.first >= size; });
+      if (!ranges_.empty() && ranges_.back().end() > size) {
+        ranges_.back().count = size - ranges_.back().first;
+      }
+    }
+
+   private:
+    std::size_t gap_{ 64 };
+    std::vector<Range> ranges_{};
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+#include <brabbit/distance.hpp>
+#include <brabbit/parallel.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto GRAIN = std::size_t{ 1024 };
+
+    // World placement of a model and the way back into its mesh space.
+    struct Placement {
+      glm::mat4 world{ 1.0f };
+      glm::mat4 local{ 1.0f };
+      float scale{ 1.0f };  // uniform scale of world, converts mesh distances to world distances
+    };
+
+    auto GetPlacement(const glm::mat4& world) -> Placement {
+      const auto scale = std::cbrt(std::abs(glm::determinant(glm::mat3{ world })));
+      return { world, glm::inverse(world), scale > 0.0f ? scale : 1.0f };
+    }
+
+    auto GetWorld(const Model& model) -> glm::mat4 {
+      // models outside of a scene are placed by their model matrix alone
+      return model.getScene() ? model.getScaledModel() : model.getModel();
+    }
+
+    auto TransformPoint(const glm::mat4& matrix, const glm::vec3& point) -> glm::vec3 {
+      return glm::vec3{ matrix * glm::vec4{ point, 1.0f } };
+    }
+
+    auto AtomicMax(std::atomic<float>& target, float value) -> void {
+      auto current = target.load(std::memory_order_relaxed);
+      while (current < value &&
+             !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+      }
+    }
+
+    // First point where an edge of `from` passes through the surface of `to`.
+    auto FindCrossing(const Mesh& from,
+                      const Placement& from_placement,
+                      const Mesh& to,
+                      const Placement& to_placement) -> std::optional<glm::vec3> {
+      const auto& vertices = from.getVertices();
+      const auto& indices = from.getIndices();
+      const auto to_local = to_placement.local * from_placement.world;
+
+      auto found = std::atomic<bool>{ false };
+      auto crossings = std::vector<std::optional<glm::vec3>>(
+          GetParallelChunkCount(indices.size(), GRAIN));
+
+      ParallelFor(indices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+        for (auto i = begin; i < end && !found.load(std::memory_order_relaxed); ++i) {
+          const auto& triangle = indices[i];
+          for (auto edge = 0; edge < 3; ++edge) {
+            const auto a = TransformPoint(to_local, vertices[triangle[edge]]);
+            const auto b = TransformPoint(to_local, vertices[triangle[(edge + 1) % 3]]);
+
+            // unnormalized direction, the hit distance is the parameter along the edge
+            auto hit = RayHit{ .distance = 1.0f };
+            if (to.intersect({ a, b - a }, hit)) {
+              crossings[chunk] = TransformPoint(to_placement.world, a + (b - a) * hit.distance);
+              found = true;
+              return;
+            }
+          }
+        }
+      });
+
+      for (const auto& crossing : crossings) {
+        if (crossing) {
+          return crossing;
+        }
+      }
+      return std::nullopt;
+    }
+
+    // Closest pair between the vertices of `from` and the surface of `to`, in world space.
+    auto FindClosestPair(const Mesh& from,
+                         const Placement& from_placement,
+                         const Mesh& to,
+                         const Placement& to_placement) -> Clearance {
+      const auto& vertices = from.getVertices();
+      const auto to_local = to_placement.local * from_placement.world;
+
+      auto partials = std::vector<Clearance>(GetParallelChunkCount(vertices.size(), GRAIN));
+      ParallelFor(vertices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto& best = partials[chunk];
+        for (auto i = begin; i < end; ++i) {
+          const auto point = TransformPoint(to_local, vertices[i]);
+          const auto closest = to.closestPoint(point, best.distance / to_placement.scale);
+          if (closest.primitive == INVALID_INDEX) {
+            continue;
+          }
+
+          best = {
+            closest.distance * to_placement.scale,
+            TransformPoint(from_placement.world, vertices[i]),
+            TransformPoint(to_placement.world, closest.position),
+          };
+        }
+      });
+
+      auto result = Clearance{};
+      for (const auto& partial : partials) {
+        if (partial.distance < result.distance) {
+          result = partial;
+        }
+      }
+      return result;
+    }
+
+    // Closest points of segments p1 q1 and p2 q2 (Ericson, Real-Time Collision Detection 5.1.9).
+    auto ClosestPointsOnSegments(const glm::vec3& p1,
+                                 const glm::vec3& q1,
+                                 const glm::vec3& p2,
+                                 const glm::vec3& q2) -> std::pair<glm::vec3, glm::vec3> {
+      constexpr auto EPSILON = 1e-12f;
+
+      const auto d1 = q1 - p1;
+      const auto d2 = q2 - p2;
+      const auto r = p1 - p2;
+      const auto a = glm::dot(d1, d1);
+      const auto e = glm::dot(d2, d2);
+      const auto f = glm::dot(d2, r);
+
+      auto s = 0.0f;
+      auto t = 0.0f;
+      if (a <= EPSILON && e <= EPSILON) {
+        return { p1, p2 };
+      }
+
+      if (a <= EPSILON) {
+        t = std::clamp(f / e, 0.0f, 1.0f);
+      } else {
+        const auto c = glm::dot(d1, r);
+        if (e <= EPSILON) {
+          s = std::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+          // closest points of the lines, clamped to the first segment, then to the second
+          const auto b = glm::dot(d1, d2);
+          const auto denominator = a * e - b * b;
+          s = denominator > 0.0f ? std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+          t = (b * s + f) / e;
+          if (t < 0.0f) {
+            t = 0.0f;
+            s = std::clamp(-c / a, 0.0f, 1.0f);
+          } else if (t > 1.0f) {
+            t = 1.0f;
+            s = std::clamp((b - c) / a, 0.0f, 1.0f);
+          }
+        }
+      }
+      return { p1 + d1 * s, p2 + d2 * t };
+    }
+
+    // Closest pair between the edges of `from` and the edges of `to`, only pairs closer than
+    // `bound` are searched. Edge / edge contacts are the ones FindClosestPair overestimates.
+    auto FindClosestEdgePair(const Mesh& from,
+                             const Placement& from_placement,
+                             const Mesh& to,
+                             const Placement& to_placement,
+                             const Clearance& bound) -> Clearance {
+      const auto& vertices = from.getVertices();
+      const auto& indices = from.getIndices();
+      const auto& to_vertices = to.getVertices();
+      const auto& to_indices = to.getIndices();
+      const auto to_local = to_placement.local * from_placement.world;
+      const auto& bvh = to.getBvh();
+
+      auto partials = std::vector<Clearance>(GetParallelChunkCount(indices.size(), GRAIN), bound);
+      ParallelFor(indices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto& best = partials[chunk];
+        for (auto i = begin; i < end; ++i) {
+          const auto& triangle = indices[i];
+          for (auto edge = 0; edge < 3; ++edge) {
+            const auto a = TransformPoint(to_local, vertices[triangle[edge]]);
+            const auto b = TransformPoint(to_local, vertices[triangle[(edge + 1) % 3]]);
+
+            // every point of the edge lies within half its length of its middle
+            const auto middle = (a + b) * 0.5f;
+            const auto half = glm::length(b - a) * 0.5f;
+            auto nearest = best.distance / to_placement.scale;
+            bvh.traverseNearest(middle, nearest + half, [&](auto primitive, auto& max) {
+              const auto& ids = to_indices[primitive];
+              for (auto other = 0; other < 3; ++other) {
+                const auto [from_point, to_point] = ClosestPointsOnSegments(
+                    a, b, to_vertices[ids[other]], to_vertices[ids[(other + 1) % 3]]);
+                const auto distance = glm::length(to_point - from_point);
+                if (distance >= nearest) {
+                  continue;
+                }
+
+                nearest = distance;
+                max = (nearest + half) * (nearest + half);
+                best = {
+                  distance * to_placement.scale,
+                  TransformPoint(to_placement.world, from_point),
+                  TransformPoint(to_placement.world, to_point),
+                };
+              }
+            });
+          }
+        }
+      });
+
+      auto result = bound;
+      for (const auto& partial : partials) {
+        if (partial.distance < result.distance) {
+          result = partial;
+        }
+      }
+      return result;
+    }
+
+    auto ComputeOneSidedHausdorff(const Mesh& from,
+                                  const Placement& from_placement,
+                                  const Mesh& to,
+                                  const Placement& to_placement) -> float {
+      const auto& vertices = from.getVertices();
+      const auto& indices = to.getIndices();
+      const auto& to_vertices = to.getVertices();
+      const auto to_local = to_placement.local * from_placement.world;
+      if (indices.empty()) {
+        return std::numeric_limits<float>::infinity();
+      }
+
+      // distance in mesh space of `to`, converted to world space at the end
+      auto maximum = std::atomic<float>{ 0.0f };
+      ParallelFor(vertices.size(), GRAIN, [&](auto, auto begin, auto end) {
+        for (auto i = begin; i < end; ++i) {
+          const auto point = TransformPoint(to_local, vertices[i]);
+          const auto current = maximum.load(std::memory_order_relaxed);
+          const auto current_squared = current * current;
+
+          auto nearest = std::numeric_limits<float>::infinity();
+          to.getBvh().traverseNearest(point, nearest, [&](auto primitive, auto& max) {
+            const auto& triangle = indices[primitive];
+            const auto position = ClosestPointOnTriangle(
+                point, to_vertices[triangle.x], to_vertices[triangle.y], to_vertices[triangle.z]);
+            const auto delta = position - point;
+            const auto distance_squared = glm::dot(delta, delta);
+            if (distance_squared >= max) {
+              return;
+            }
+
+            max = distance_squared;
+            nearest = distance_squared;
+
+            // this vertex can no longer raise the maximum, stop searching
+            if (distance_squared <= current_squared) {
+              max = 0.0f;
+            }
+          });
+
+          AtomicMax(maximum, std::sqrt(nearest));
+        }
+      });
+
+      return maximum.load() * to_placement.scale;
+    }
+
+  }  // namespace
+
+  auto ComputeClearance(const Model& lhs, const Model& rhs) -> Clearance {
+    const auto* lhs_mesh = lhs.getMesh();
+    const auto* rhs_mesh = rhs.getMesh();
+    if (!lhs_mesh || !rhs_mesh) {
+      return {};
+    }
+
+    return ComputeClearance(*lhs_mesh, GetWorld(lhs), *rhs_mesh, GetWorld(rhs));
+  }
+
+  auto ComputeClearance(const Mesh& lhs,
+                        const glm::mat4& lhs_world,
+                        const Mesh& rhs,
+                        const glm::mat4& rhs_world) -> Clearance {
+    const auto lhs_placement = GetPlacement(lhs_world);
+    const auto rhs_placement = GetPlacement(rhs_world);
+
+    auto crossing = FindCrossing(lhs, lhs_placement, rhs, rhs_placement);
+    if (!crossing) {
+      crossing = FindCrossing(rhs, rhs_placement, lhs, lhs_placement);
+    }
+    if (crossing) {
+      return { 0.0f, *crossing, *crossing };
+    }
+
+    // vertex / face pairs bound the gap, edge / edge pairs below that bound close it
+    auto result = FindClosestPair(lhs, lhs_placement, rhs, rhs_placement);
+    auto reverse = FindClosestPair(rhs, rhs_placement, lhs, lhs_placement);
+    if (reverse.distance < result.distance) {
+      result = { reverse.distance, reverse.to, reverse.from };
+    }
+    return FindClosestEdgePair(lhs, lhs_placement, rhs, rhs_placement, result);
+  }
+
+  auto ComputeHausdorffDistance(const Model& from, const Model& to, HausdorffMode mode) -> float {
+    const auto* from_mesh = from.getMesh();
+    const auto* to_mesh = to.getMesh();
+    if (!from_mesh || !to_mesh) {
+      return std::numeric_limits<float>::infinity();
+    }
+
+    return ComputeHausdorffDistance(*from_mesh, GetWorld(from), *to_mesh, GetWorld(to), mode);
+  }
+
+  auto ComputeHausdorffDistance(const Mesh& from,
+                                const glm::mat4& from_world,
+                                const Mesh& to,
+                                const glm::mat4& to_world,
+                                HausdorffMode mode) -> float {
+    const auto from_placement = GetPlacement(from_world);
+    const auto to_placement = GetPlacement(to_world);
+
+    auto distance = ComputeOneSidedHausdorff(from, from_placement, to, to_placement);
+    if (mode == HausdorffMode::SYMMETRIC) {
+      distance =
+          std::max(distance, ComputeOneSidedHausdorff(to, to_placement, from, from_placement));
+    }
+    return distance;
+  }
+
+  auto ComputeDeviation(const Model& from, const Model& to) -> std::vector<float> {
+    const auto* from_mesh = from.getMesh();
+    const auto* to_mesh = to.getMesh();
+    if (!from_mesh || !to_mesh) {
+      return {};
+    }
+
+    return ComputeDeviation(*from_mesh, GetWorld(from), *to_mesh, GetWorld(to));
+  }
+
+  auto ComputeDeviation(const Mesh& from,
+                        const glm::mat4& from_world,
+                        const Mesh& to,
+                        const glm::mat4& to_world) -> std::vector<float> {
+    const auto from_placement = GetPlacement(from_world);
+    const auto to_placement = GetPlacement(to_world);
+    const auto to_local = to_placement.local * from_placement.world;
+
+    const auto& vertices = from.getVertices();
+    const auto& indices = to.getIndices();
+    const auto& to_vertices = to.getVertices();
+
+    auto deviation = std::vector<float>(vertices.size(), 0.0f);
+    ParallelFor(vertices.size(), GRAIN, [&](auto, auto begin, auto end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto point = TransformPoint(to_local, vertices[i]);
+        const auto closest = to.closestPoint(point);
+        if (closest.primitive == INVALID_INDEX) {
+          continue;
+        }
+
+        // the side of the closest face decides the sign
+        const auto& triangle = indices[closest.primitive];
+        const auto& a = to_vertices[triangle.x];
+        const auto normal = glm::cross(to_vertices[triangle.y] - a, to_vertices[triangle.z] - a);
+        const auto sign = glm::dot(point - closest.position, normal) < 0.0f ? -1.0f : 1.0f;
+        deviation[i] = sign * closest.distance * to_placement.scale;
+      }
+    });
+
+    return deviation;
+  }
+
+  auto MapDeviationColors(std::span<const float> deviation, float max_deviation)
+      -> std::vector<glm::vec4> {
+    constexpr auto NEGATIVE = glm::vec4{ 0.0f, 0.0f, 1.0f, 1.0f };
+    constexpr auto ZERO = glm::vec4{ 0.0f, 1.0f, 0.0f, 1.0f };
+    constexpr auto POSITIVE = glm::vec4{ 1.0f, 0.0f, 0.0f, 1.0f };
+
+    const auto scale = max_deviation > 0.0f ? 1.0f / max_deviation : 0.0f;
+
+    auto colors = std::vector<glm::vec4>(deviation.size());
+    std::transform(deviation.begin(), deviation.end(), colors.begin(), [&](float value) {
+      const auto t = std::clamp(value * scale, -1.0f, 1.0f);
+      return t < 0.0f ? glm::mix(ZERO, NEGATIVE, -t) : glm::mix(ZERO, POSITIVE, t);
+    });
+    return colors;
+  }
+
+}  // namespace brabbit
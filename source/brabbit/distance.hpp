@@ -0,0 +1,59 @@
+#pragma once
+
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/model.hpp>
+
+namespace brabbit {
+
+  enum class HausdorffMode {
+    ONE_SIDED,  // max distance from the first model's vertices to the second model's surface
+    SYMMETRIC,  // max of both one sided distances
+  };
+
+  struct Clearance {
+    float     distance{ std::numeric_limits<float>::infinity() };  // 0 when the surfaces cross
+    glm::vec3 from{ 0.0f, 0.0f, 0.0f };  // closest points in world space
+    glm::vec3 to{ 0.0f, 0.0f, 0.0f };
+  };
+
+  // Distances are measured in world space between the models' placements, which are expected to
+  // be rigid or uniformly scaled. The mesh overloads take the placements as world matrices, for
+  // callers without a scene such as tools.
+
+  // Minimum gap between two models, 0 when an edge of one passes through the other. Both vertex /
+  // face and edge / edge pairs are searched, so the gap is exact up to rounding.
+  auto ComputeClearance(const Model& lhs, const Model& rhs) -> Clearance;
+  auto ComputeClearance(const Mesh& lhs,
+                        const glm::mat4& lhs_world,
+                        const Mesh& rhs,
+                        const glm::mat4& rhs_world) -> Clearance;
+
+  // Vertices of `from` are matched against the surface of `to`.
+  auto ComputeHausdorffDistance(const Model& from,
+                                const Model& to,
+                                HausdorffMode mode = HausdorffMode::SYMMETRIC) -> float;
+  auto ComputeHausdorffDistance(const Mesh& from,
+                                const glm::mat4& from_world,
+                                const Mesh& to,
+                                const glm::mat4& to_world,
+                                HausdorffMode mode = HausdorffMode::SYMMETRIC) -> float;
+
+  // Signed distance of every vertex of `from` to the surface of `to`, positive outside.
+  auto ComputeDeviation(const Model& from, const Model& to) -> std::vector<float>;
+  auto ComputeDeviation(const Mesh& from,
+                        const glm::mat4& from_world,
+                        const Mesh& to,
+                        const glm::mat4& to_world) -> std::vector<float>;
+
+  // Blue (-max_deviation) -> green (0) -> red (+max_deviation) colors for a deviation overlay.
+  auto MapDeviationColors(std::span<const float> deviation, float max_deviation)
+      -> std::vector<glm::vec4>;
+
+}  // namespace brabbit
@@ -12,14 +12,6 @@ namespace brabbit {
     setMat4("model"sv, model);
   }
 
-  auto FlatShader::setView(const glm::mat4& view) const -> void {
-    setMat4("view"sv, view);
-  }
-
-  auto FlatShader::setProjection(const glm::mat4& projection) const -> void {
-    setMat4("projection"sv, projection);
-  }
-
   auto FlatShader::setLightColor(const glm::vec4& color) const -> void {
     setVec4("light_color"sv, color);
   }
@@ -0,0 +1,39 @@
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include <brabbit/frame_data.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/upload_ring.hpp>
+
+namespace brabbit {
+
+  FrameDataBuffer::FrameDataBuffer() {
+    glCreateBuffers(1, &buffer_);
+    glNamedBufferStorage(buffer_, sizeof(FrameData), nullptr, GL_DYNAMIC_STORAGE_BIT);
+  }
+
+  FrameDataBuffer::~FrameDataBuffer() {
+    GetRenderState().forgetBuffer(buffer_);
+    glDeleteBuffers(1, &buffer_);
+  }
+
+  auto FrameDataBuffer::update(const FrameData& data) -> void {
+    // the block is read straight from the ring, the frame's segment outlives its draws
+    if (auto* ring = GetUploadRing(); ring) {
+      if (const auto allocation = ring->allocate(sizeof(FrameData)); allocation.data) {
+        std::memcpy(allocation.data, &data, sizeof(FrameData));
+        glBindBufferRange(GL_UNIFORM_BUFFER,
+                          BINDING,
+                          allocation.buffer,
+                          static_cast<GLintptr>(allocation.offset),
+                          sizeof(FrameData));
+        return;
+      }
+    }
+
+    glNamedBufferSubData(buffer_, 0, sizeof(FrameData), &data);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer_);
+  }
+
+}  // namespace brabbit
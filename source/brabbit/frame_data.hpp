@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  // Camera and light of a frame, the std140 FrameData block of the shaders. A vec3 takes the
+  // room of a vec4, unless a float follows to fill it.
+  struct FrameData {
+    glm::mat4 view{ 1.0f };
+    glm::mat4 projection{ 1.0f };
+    glm::mat4 view_projection{ 1.0f };
+    glm::vec3 camera_position{ 0.0f };
+    float padding0{ 0.0f };
+    glm::vec4 light_color{ 1.0f };
+    glm::vec3 light_position{ 0.0f };
+    float ambient_strength{ 0.0f };
+    float specular_strength{ 0.0f };
+    float padding1[3]{};
+  };
+
+  static_assert(offsetof(FrameData, view) == 0);
+  static_assert(offsetof(FrameData, projection) == 64);
+  static_assert(offsetof(FrameData, view_projection) == 128);
+  static_assert(offsetof(FrameData, camera_position) == 192);
+  static_assert(offsetof(FrameData, light_color) == 208);
+  static_assert(offsetof(FrameData, light_position) == 224);
+  static_assert(offsetof(FrameData, ambient_strength) == 236);
+  static_assert(offsetof(FrameData, specular_strength) == 240);
+  static_assert(sizeof(FrameData) == 256);
+
+  // Uniform buffer behind the FrameData block, written once a frame and bound at BINDING for
+  // every program that declares the block.
+  class FrameDataBuffer {
+   public:
+    explicit FrameDataBuffer();
+    virtual ~FrameDataBuffer();
+
+    FrameDataBuffer(const FrameDataBuffer&) = delete;
+    auto operator=(const FrameDataBuffer&) -> FrameDataBuffer& = delete;
+
+   public:
+    auto update(const FrameData& data) -> void;
+
+   public:
+    static constexpr auto BINDING = 0u;
+
+   private:
+    unsigned int buffer_{ 0 };
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/geometry_arena.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/upload_ring.hpp>
+#include <brabbit/vertex_layout.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto INITIAL_VERTEX_CAPACITY = std::size_t{ 1 } << 16;
+    constexpr auto INITIAL_TRIANGLE_CAPACITY = std::size_t{ 1 } << 16;
+
+    constexpr auto POSITION_BINDING = 0u;
+    constexpr auto NORMAL_BINDING = 1u;
+    constexpr auto OCCLUSION_BINDING = 2u;
+    constexpr auto INSTANCE_BINDING = 3u;
+    constexpr auto OBJECT_INDEX_LOCATION = 3u;
+
+    // a stream per attribute, so each buffer grows and compacts on its own, the instance buffer
+    // only holds object indices, everything else is in the objects buffer
+    using ArenaLayout = VertexLayout<VertexAttribute<0, glm::vec3, POSITION_BINDING>,
+                                     VertexAttribute<1, glm::vec3, NORMAL_BINDING>,
+                                     VertexAttribute<2, float, OCCLUSION_BINDING>,
+                                     InstanceAttribute<OBJECT_INDEX_LOCATION,
+                                                       std::uint32_t,
+                                                       INSTANCE_BINDING>>;
+
+    // the position stream and the instances of the same buffers, nothing else is fetched
+    using DepthLayout = VertexLayout<VertexAttribute<0, glm::vec3, POSITION_BINDING>,
+                                     InstanceAttribute<OBJECT_INDEX_LOCATION,
+                                                       std::uint32_t,
+                                                       INSTANCE_BINDING>>;
+
+    constexpr auto POSITION_STRIDE = std::size_t{ ArenaLayout::STRIDES[POSITION_BINDING] };
+    constexpr auto NORMAL_STRIDE = std::size_t{ ArenaLayout::STRIDES[NORMAL_BINDING] };
+    constexpr auto OCCLUSION_STRIDE = std::size_t{ ArenaLayout::STRIDES[OCCLUSION_BINDING] };
+    constexpr auto VERTEX_STRIDE = POSITION_STRIDE + NORMAL_STRIDE + OCCLUSION_STRIDE;
+    constexpr auto TRIANGLE_STRIDE = sizeof(glm::uvec3);
+
+    // Immutable storage can not be resized, a larger buffer takes over the contents instead.
+    auto GrowBuffer(unsigned int& buffer, std::size_t size, std::size_t capacity) -> void {
+      auto grown = 0u;
+      glCreateBuffers(1, &grown);
+      glNamedBufferStorage(
+          grown, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_STORAGE_BIT);
+      if (buffer) {
+        glCopyNamedBufferSubData(buffer, grown, 0, 0, static_cast<GLsizeiptr>(size));
+        GetRenderState().forgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+      }
+      buffer = grown;
+    }
+
+    // Regions of one buffer, the arena only copies between ranges that do not overlap.
+    auto CopyRegion(unsigned int buffer, std::size_t from, std::size_t to, std::size_t size)
+        -> void {
+      glCopyNamedBufferSubData(buffer,
+                               buffer,
+                               static_cast<GLintptr>(from),
+                               static_cast<GLintptr>(to),
+                               static_cast<GLsizeiptr>(size));
+    }
+
+    auto GetArenaCache() -> std::weak_ptr<GeometryArena>& {
+      static auto Cache = std::weak_ptr<GeometryArena>{};
+      return Cache;
+    }
+
+  }  // namespace
+
+  GeometryArena::GeometryArena() {
+    glCreateVertexArrays(1, &vao_);
+    glCreateVertexArrays(1, &depth_vao_);
+
+    // the buffers behind the bindings change when they grow
+    ArenaLayout::Apply(vao_);
+    DepthLayout::Apply(depth_vao_);
+
+    reserve(INITIAL_VERTEX_CAPACITY, INITIAL_TRIANGLE_CAPACITY);
+  }
+
+  GeometryArena::~GeometryArena() {
+    auto& state = GetRenderState();
+    for (const auto buffer : { buffers_.position_vbo,
+                               buffers_.normal_vbo,
+                               buffers_.occlusion_vbo,
+                               buffers_.index_ebo }) {
+      state.forgetBuffer(buffer);
+    }
+    state.forgetVertexArray(vao_);
+    state.forgetVertexArray(depth_vao_);
+
+    glDeleteBuffers(1, &buffers_.position_vbo);
+    glDeleteBuffers(1, &buffers_.normal_vbo);
+    glDeleteBuffers(1, &buffers_.occlusion_vbo);
+    glDeleteBuffers(1, &buffers_.index_ebo);
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteVertexArrays(1, &depth_vao_);
+  }
+
+  auto GeometryArena::getVao() const -> unsigned int {
+    return vao_;
+  }
+
+  auto GeometryArena::getDepthVao() const -> unsigned int {
+    return depth_vao_;
+  }
+
+  auto GeometryArena::getFragmentation() const -> float {
+    return std::max(vertices_.getFragmentation(), triangles_.getFragmentation());
+  }
+
+  auto GeometryArena::reserve(std::size_t vertex_count, std::size_t triangle_count) -> void {
+    if (vertices_.getLargestFree() < vertex_count) {
+      const auto size = vertices_.getCapacity();
+      const auto capacity = std::max(size * 2, size + vertex_count);
+      GrowBuffer(buffers_.position_vbo, size * POSITION_STRIDE, capacity * POSITION_STRIDE);
+      GrowBuffer(buffers_.normal_vbo, size * NORMAL_STRIDE, capacity * NORMAL_STRIDE);
+      GrowBuffer(buffers_.occlusion_vbo, size * OCCLUSION_STRIDE, capacity * OCCLUSION_STRIDE);
+      vertices_.grow(capacity);
+
+      ArenaLayout::BindBuffer(vao_, POSITION_BINDING, buffers_.position_vbo);
+      ArenaLayout::BindBuffer(vao_, NORMAL_BINDING, buffers_.normal_vbo);
+      ArenaLayout::BindBuffer(vao_, OCCLUSION_BINDING, buffers_.occlusion_vbo);
+      DepthLayout::BindBuffer(depth_vao_, POSITION_BINDING, buffers_.position_vbo);
+    }
+
+    if (triangles_.getLargestFree() < triangle_count) {
+      const auto size = triangles_.getCapacity();
+      const auto capacity = std::max(size * 2, size + triangle_count);
+      GrowBuffer(buffers_.index_ebo, size * TRIANGLE_STRIDE, capacity * TRIANGLE_STRIDE);
+      triangles_.grow(capacity);
+
+      glVertexArrayElementBuffer(vao_, buffers_.index_ebo);
+      glVertexArrayElementBuffer(depth_vao_, buffers_.index_ebo);
+    }
+  }
+
+  auto GeometryArena::acquire(const Mesh& mesh) -> std::shared_ptr<const GeometryRange> {
+    if (auto iter = meshes_.find(&mesh); iter != meshes_.cend()) {
+      if (auto range = iter->second.lock(); range) {
+        return range;
+      }
+    }
+
+    const auto vertex_count = mesh.getVertices().size();
+    const auto triangle_count = mesh.getIndices().size();
+    reserve(vertex_count, triangle_count);
+
+    auto* range = new GeometryRange{};
+    range->base_vertex = *vertices_.allocate(vertex_count);
+    range->vertex_count = vertex_count;
+    range->first_triangle = *triangles_.allocate(triangle_count);
+    range->triangle_count = triangle_count;
+    if (vertex_count) {
+      vertex_owners_.emplace(range->base_vertex, range);
+    }
+    if (triangle_count) {
+      triangle_owners_.emplace(range->first_triangle, range);
+    }
+
+    UploadBufferData(buffers_.position_vbo,
+                     range->base_vertex * POSITION_STRIDE,
+                     mesh.getVerticesData(),
+                     mesh.getVerticesSize());
+    UploadBufferData(buffers_.normal_vbo,
+                     range->base_vertex * NORMAL_STRIDE,
+                     mesh.getNormalsData(),
+                     std::min(mesh.getNormals().size(), vertex_count) * NORMAL_STRIDE);
+
+    // meshes without baked ambient occlusion are fully lit
+    const auto* occlusion = mesh.getAmbientOcclusionData();
+    auto unoccluded = std::vector<float>{};
+    if (mesh.getAmbientOcclusion().size() != vertex_count) {
+      unoccluded.assign(vertex_count, 1.0f);
+      occlusion = unoccluded.data();
+    }
+    UploadBufferData(buffers_.occlusion_vbo,
+                     range->base_vertex * OCCLUSION_STRIDE,
+                     occlusion,
+                     vertex_count * OCCLUSION_STRIDE);
+
+    UploadBufferData(buffers_.index_ebo,
+                     range->first_triangle * TRIANGLE_STRIDE,
+                     mesh.getIndicesData(),
+                     mesh.getIndicesSize());
+
+    auto shared = std::shared_ptr<GeometryRange>{
+      range, [this, key = &mesh](GeometryRange* range) { release(key, range); }
+    };
+    meshes_.insert_or_assign(&mesh, shared);
+    return shared;
+  }
+
+  auto GeometryArena::release(const Mesh* mesh, GeometryRange* range) -> void {
+    if (auto iter = meshes_.find(mesh); iter != meshes_.cend() && iter->second.expired()) {
+      meshes_.erase(iter);
+    }
+
+    if (range->vertex_count) {
+      vertex_owners_.erase(range->base_vertex);
+      vertices_.release(range->base_vertex, range->vertex_count);
+    }
+    if (range->triangle_count) {
+      triangle_owners_.erase(range->first_triangle);
+      triangles_.release(range->first_triangle, range->triangle_count);
+    }
+    delete range;
+  }
+
+  auto GeometryArena::setInstanceBuffer(unsigned int buffer) -> void {
+    ArenaLayout::BindBuffer(vao_, INSTANCE_BINDING, buffer);
+    DepthLayout::BindBuffer(depth_vao_, INSTANCE_BINDING, buffer);
+  }
+
+  auto GeometryArena::draw(const GeometryRange& range,
+                           std::size_t first_instance,
+                           std::size_t instance_count) const -> void {
+    const auto offset = range.first_triangle * TRIANGLE_STRIDE;
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+                                                  static_cast<GLsizei>(range.triangle_count * 3),
+                                                  GL_UNSIGNED_INT,
+                                                  reinterpret_cast<void*>(offset),
+                                                  static_cast<GLsizei>(instance_count),
+                                                  static_cast<GLint>(range.base_vertex),
+                                                  static_cast<GLuint>(first_instance));
+  }
+
+  auto GeometryArena::getDrawCommand(const GeometryRange& range,
+                                     std::size_t first_instance,
+                                     std::size_t instance_count) const
+      -> DrawElementsIndirectCommand {
+    return DrawElementsIndirectCommand{ static_cast<std::uint32_t>(range.triangle_count * 3),
+                                        static_cast<std::uint32_t>(instance_count),
+                                        static_cast<std::uint32_t>(range.first_triangle * 3),
+                                        static_cast<std::int32_t>(range.base_vertex),
+                                        static_cast<std::uint32_t>(first_instance) };
+  }
+
+  auto GeometryArena::drawIndirect(std::size_t first_command, std::size_t command_count) const
+      -> void {
+    const auto offset = first_command * sizeof(DrawElementsIndirectCommand);
+    glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                GL_UNSIGNED_INT,
+                                reinterpret_cast<void*>(offset),
+                                static_cast<GLsizei>(command_count),
+                                sizeof(DrawElementsIndirectCommand));
+  }
+
+  auto GeometryArena::moveVertices(GeometryRange& range, std::size_t base_vertex)
+      -> std::size_t {
+    const auto from = range.base_vertex;
+    const auto count = range.vertex_count;
+    CopyRegion(buffers_.position_vbo,
+               from * POSITION_STRIDE,
+               base_vertex * POSITION_STRIDE,
+               count * POSITION_STRIDE);
+    CopyRegion(buffers_.normal_vbo,
+               from * NORMAL_STRIDE,
+               base_vertex * NORMAL_STRIDE,
+               count * NORMAL_STRIDE);
+    CopyRegion(buffers_.occlusion_vbo,
+               from * OCCLUSION_STRIDE,
+               base_vertex * OCCLUSION_STRIDE,
+               count * OCCLUSION_STRIDE);
+
+    vertex_owners_.erase(from);
+    vertex_owners_.emplace(base_vertex, &range);
+    vertices_.release(from, count);
+    range.base_vertex = base_vertex;
+    return count * VERTEX_STRIDE;
+  }
+
+  auto GeometryArena::moveTriangles(GeometryRange& range, std::size_t first_triangle)
+      -> std::size_t {
+    const auto from = range.first_triangle;
+    const auto count = range.triangle_count;
+    CopyRegion(buffers_.index_ebo,
+               from * TRIANGLE_STRIDE,
+               first_triangle * TRIANGLE_STRIDE,
+               count * TRIANGLE_STRIDE);
+
+    triangle_owners_.erase(from);
+    triangle_owners_.emplace(first_triangle, &range);
+    triangles_.release(from, count);
+    range.first_triangle = first_triangle;
+    return count * TRIANGLE_STRIDE;
+  }
+
+  auto GeometryArena::defragment(std::size_t budget) -> void {
+    // draws already issued read the old places, GL orders the copies after them
+    auto moved = std::size_t{ 0 };
+
+    if (vertices_.getFragmentation() > FRAGMENTATION_THRESHOLD) {
+      auto owners = std::vector<GeometryRange*>{};
+      for (auto iter = vertex_owners_.rbegin(); iter != vertex_owners_.rend(); ++iter) {
+        owners.push_back(iter->second);
+      }
+
+      for (auto* range : owners) {
+        if (moved >= budget || vertices_.getFragmentation() <= FRAGMENTATION_THRESHOLD) {
+          break;
+        }
+
+        const auto target = vertices_.allocate(range->vertex_count);
+        if (!target) {
+          continue;
+        }
+        if (*target > range->base_vertex) {
+          vertices_.release(*target, range->vertex_count);
+          continue;
+        }
+        moved += moveVertices(*range, *target);
+      }
+    }
+
+    if (triangles_.getFragmentation() > FRAGMENTATION_THRESHOLD) {
+      auto owners = std::vector<GeometryRange*>{};
+      for (auto iter = triangle_owners_.rbegin(); iter != triangle_owners_.rend(); ++iter) {
+        owners.push_back(iter->second);
+      }
+
+      for (auto* range : owners) {
+        if (moved >= budget || triangles_.getFragmentation() <= FRAGMENTATION_THRESHOLD) {
+          break;
+        }
+
+        const auto target = triangles_.allocate(range->triangle_count);
+        if (!target) {
+          continue;
+        }
+        if (*target > range->first_triangle) {
+          triangles_.release(*target, range->triangle_count);
+          continue;
+        }
+        moved += moveTriangles(*range, *target);
+      }
+    }
+  }
+
+  auto AcquireGeometryArena() -> std::shared_ptr<GeometryArena> {
+    auto& cache = GetArenaCache();
+    if (auto arena = cache.lock(); arena) {
+      return arena;
+    }
+
+    auto arena = std::make_shared<GeometryArena>();
+    cache = arena;
+    return arena;
+  }
+
+  auto GetGeometryArena() -> GeometryArena* {
+    return GetArenaCache().lock().get();
+  }
+
+}  // namespace brabbit
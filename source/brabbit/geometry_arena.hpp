@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include <brabbit/mesh.hpp>
+#include <brabbit/range_allocator.hpp>
+
+namespace brabbit {
+
+  // Place of a mesh in the arena, in elements. The arena rewrites it when it moves the mesh.
+  struct GeometryRange {
+    std::size_t base_vertex{ 0 };
+    std::size_t vertex_count{ 0 };
+    std::size_t first_triangle{ 0 };
+    std::size_t triangle_count{ 0 };
+  };
+
+  // Record of glMultiDrawElementsIndirect, the layout is fixed by GL.
+  struct DrawElementsIndirectCommand {
+    std::uint32_t count{ 0 };
+    std::uint32_t instance_count{ 0 };
+    std::uint32_t first_index{ 0 };
+    std::int32_t base_vertex{ 0 };
+    std::uint32_t base_instance{ 0 };
+  };
+
+  // Static geometry of every model in a few large immutable buffers, drawn through one VAO with
+  // base vertex draws. Position, normal and occlusion share the vertex offsets, instances come
+  // from the buffer set with setInstanceBuffer.
+  class GeometryArena {
+   public:
+    explicit GeometryArena();
+    virtual ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    auto operator=(const GeometryArena&) -> GeometryArena& = delete;
+
+   public:
+    auto getVao() const -> unsigned int;
+
+    // Positions and instances only, for depth only passes over the same draws.
+    auto getDepthVao() const -> unsigned int;
+
+    // Vertex or index fragmentation, whichever is worse.
+    auto getFragmentation() const -> float;
+
+    // Range of the mesh, uploaded on first use and shared by later callers. The space is given
+    // back when the last owner lets go, which has to happen before the arena goes away.
+    auto acquire(const Mesh& mesh) -> std::shared_ptr<const GeometryRange>;
+
+    // Object index per instance, read at location 3 with one value per instance.
+    auto setInstanceBuffer(unsigned int buffer) -> void;
+
+    // Instances [first_instance, first_instance + instance_count) of the range, expects one of
+    // the VAOs bound.
+    auto draw(const GeometryRange& range, std::size_t first_instance, std::size_t instance_count)
+        const -> void;
+
+    // The same draw as a record for drawIndirect.
+    auto getDrawCommand(const GeometryRange& range,
+                        std::size_t first_instance,
+                        std::size_t instance_count) const -> DrawElementsIndirectCommand;
+
+    // Commands [first_command, first_command + command_count) of the bound draw indirect buffer,
+    // expects one of the VAOs bound.
+    auto drawIndirect(std::size_t first_command, std::size_t command_count) const -> void;
+
+    // Move ranges into holes closer to the start while fragmentation is above
+    // FRAGMENTATION_THRESHOLD, copying at most `budget` bytes. Called once a frame, a badly
+    // fragmented arena is compacted over several frames.
+    auto defragment(std::size_t budget = DEFRAGMENT_BUDGET) -> void;
+
+   public:
+    static constexpr auto FRAGMENTATION_THRESHOLD = 0.5f;
+    static constexpr auto DEFRAGMENT_BUDGET = std::size_t{ 4 } << 20;
+
+   private:
+    struct Buffers {
+      unsigned int position_vbo{ 0 };
+      unsigned int normal_vbo{ 0 };
+      unsigned int occlusion_vbo{ 0 };
+      unsigned int index_ebo{ 0 };
+    };
+
+   private:
+    auto reserve(std::size_t vertex_count, std::size_t triangle_count) -> void;
+    auto release(const Mesh* mesh, GeometryRange* range) -> void;
+
+    auto moveVertices(GeometryRange& range, std::size_t base_vertex) -> std::size_t;
+    auto moveTriangles(GeometryRange& range, std::size_t first_triangle) -> std::size_t;
+
+   private:
+    unsigned int vao_{ 0 };
+    unsigned int depth_vao_{ 0 };
+    Buffers buffers_{};
+
+    RangeAllocator vertices_{};
+    RangeAllocator triangles_{};
+
+    // live ranges by offset, defragmentation moves the ones furthest back first
+    std::map<std::size_t, GeometryRange*> vertex_owners_{};
+    std::map<std::size_t, GeometryRange*> triangle_owners_{};
+
+    std::map<const Mesh*, std::weak_ptr<GeometryRange>> meshes_{};
+  };
+
+  // The arena, created by the first caller and alive while any model uses it.
+  auto AcquireGeometryArena() -> std::shared_ptr<GeometryArena>;
+
+  // The arena if one is alive, nullptr otherwise.
+  auto GetGeometryArena() -> GeometryArena*;
+
+}  // namespace brabbit
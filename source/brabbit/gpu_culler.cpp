@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <bit>
+
+#include <glad/glad.h>
+
+#include <brabbit/cull_shader.hpp>
+#include <brabbit/depth_pyramid_shader.hpp>
+#include <brabbit/gpu_culler.hpp>
+#include <brabbit/shader_registry.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto CULL_GROUP_SIZE = 64u;     // local_size_x of cull.cs
+    constexpr auto PYRAMID_GROUP_SIZE = 8u;   // local_size_x and y of depth_pyramid.cs
+
+    constexpr auto DEPTH_PYRAMID_UNIT = 0;
+
+    auto GroupCount(int size, unsigned int group_size) -> GLuint {
+      return (static_cast<GLuint>(size) + group_size - 1) / group_size;
+    }
+
+  }  // namespace
+
+  GpuCuller::GpuCuller() {
+    cull_shader_ = LoadCachedShader<CullShader>();
+    pyramid_shader_ = LoadCachedShader<DepthPyramidShader>();
+  }
+
+  GpuCuller::~GpuCuller() {
+    glDeleteTextures(1, &depth_texture_);
+    glDeleteTextures(1, &pyramid_texture_);
+  }
+
+  auto GpuCuller::isOcclusionEnabled() const -> bool {
+    return occlusion_enabled_;
+  }
+
+  auto GpuCuller::setOcclusionEnabled(bool enabled) -> void {
+    occlusion_enabled_ = enabled;
+  }
+
+  auto GpuCuller::isReady() const -> bool {
+    return cull_shader_->isReady();
+  }
+
+  auto GpuCuller::cull(const CullBuffers& buffers) -> void {
+    if (buffers.instance_count == 0) {
+      return;
+    }
+
+    const auto occlusion = occlusion_enabled_ && pyramid_valid_;
+
+    cull_shader_->use();
+    cull_shader_->setInstanceCount(static_cast<GLuint>(buffers.instance_count));
+    cull_shader_->setOcclusion(occlusion);
+    cull_shader_->setDepthPyramid(DEPTH_PYRAMID_UNIT);
+    cull_shader_->setPreviousViewProjection(pyramid_view_projection_);
+    if (occlusion) {
+      glBindTextureUnit(DEPTH_PYRAMID_UNIT, pyramid_texture_);
+    }
+
+    // binding 0 holds the objects
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers.instances);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffers.instance_commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffers.command_bounds);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers.commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers.visible_instances);
+
+    glDispatchCompute(
+        GroupCount(static_cast<int>(buffers.instance_count), CULL_GROUP_SIZE), 1, 1);
+
+    // the draw reads the counts as commands and the survivors as vertex attributes
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+  }
+
+  auto GpuCuller::updateDepthPyramid(const glm::ivec2& size, const glm::mat4& view_projection)
+      -> void {
+    if (!occlusion_enabled_ || size.x <= 0 || size.y <= 0 || !pyramid_shader_->isReady()) {
+      pyramid_valid_ = false;
+      return;
+    }
+
+    if (size != size_) {
+      resize(size);
+    }
+
+    glCopyTextureSubImage2D(depth_texture_, 0, 0, 0, 0, 0, size.x, size.y);
+
+    pyramid_shader_->use();
+    pyramid_shader_->setSource(DEPTH_PYRAMID_UNIT);
+
+    auto level_size = size;
+    for (auto level = 0; level < levels_; ++level) {
+      // level 0 copies the depth texture, every other level reduces the one before it
+      glBindTextureUnit(DEPTH_PYRAMID_UNIT, level == 0 ? depth_texture_ : pyramid_texture_);
+      pyramid_shader_->setSourceLevel(level == 0 ? 0 : level - 1);
+      glBindImageTexture(0, pyramid_texture_, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+      glDispatchCompute(GroupCount(level_size.x, PYRAMID_GROUP_SIZE),
+                        GroupCount(level_size.y, PYRAMID_GROUP_SIZE),
+                        1);
+      glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+      level_size = glm::max(level_size / 2, glm::ivec2{ 1 });
+    }
+
+    pyramid_valid_ = true;
+    pyramid_view_projection_ = view_projection;
+  }
+
+  auto GpuCuller::resize(const glm::ivec2& size) -> void {
+    glDeleteTextures(1, &depth_texture_);
+    glDeleteTextures(1, &pyramid_texture_);
+
+    size_ = size;
+    levels_ = std::bit_width(static_cast<unsigned int>(std::max(size.x, size.y)));
+    pyramid_valid_ = false;
+
+    // texelFetch only, but a texture without complete mipmaps needs a filter that ignores them
+    glCreateTextures(GL_TEXTURE_2D, 1, &depth_texture_);
+    glTextureStorage2D(depth_texture_, 1, GL_DEPTH_COMPONENT24, size.x, size.y);
+    glTextureParameteri(depth_texture_, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(depth_texture_, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &pyramid_texture_);
+    glTextureStorage2D(pyramid_texture_, levels_, GL_R32F, size.x, size.y);
+    glTextureParameteri(pyramid_texture_, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTextureParameteri(pyramid_texture_, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  class CullShader;
+  class DepthPyramidShader;
+
+  // Buffers of one cull, all indexed the way the indirect draw reads them. The objects the
+  // instances refer to are read from the bound ObjectBuffer.
+  struct CullBuffers {
+    unsigned int instances{ 0 };          // uint object index per instance
+    unsigned int instance_commands{ 0 };  // uint command index per instance
+    unsigned int command_bounds{ 0 };     // object space Aabb per command, as two vec4
+    unsigned int commands{ 0 };           // DrawElementsIndirectCommand, instance_count zeroed
+    unsigned int visible_instances{ 0 };  // same size as instances
+    std::size_t instance_count{ 0 };
+  };
+
+  // Visibility of instanced draws decided on the GPU. A compute pass tests every instance against
+  // the frustum and against a depth pyramid of the previous frame, then appends the survivors to
+  // their command with atomics. Commands nothing survived for draw zero instances.
+  class GpuCuller {
+   public:
+    explicit GpuCuller();
+    virtual ~GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+    auto operator=(const GpuCuller&) -> GpuCuller& = delete;
+
+   public:
+    // On by default, off leaves only the frustum test.
+    auto isOcclusionEnabled() const -> bool;
+    auto setOcclusionEnabled(bool enabled) -> void;
+
+   public:
+    // False while the cull program is still compiling, draw without culling until then.
+    auto isReady() const -> bool;
+
+    // Fills the visible instances and instance counts, ready for the indirect draw. The frustum
+    // is the one the objects' model view projection matrices were made with.
+    auto cull(const CullBuffers& buffers) -> void;
+
+    // Build the pyramid from the depth of the bound read framebuffer once the frame is drawn,
+    // the next cull tests against it. A new size starts over without occlusion for a frame, so
+    // does a pyramid program that is not compiled yet.
+    auto updateDepthPyramid(const glm::ivec2& size, const glm::mat4& view_projection) -> void;
+
+   private:
+    auto resize(const glm::ivec2& size) -> void;
+
+   private:
+    CullShader* cull_shader_{ nullptr };
+    DepthPyramidShader* pyramid_shader_{ nullptr };
+
+    bool occlusion_enabled_{ true };
+
+    unsigned int depth_texture_{ 0 };
+    unsigned int pyramid_texture_{ 0 };
+    glm::ivec2 size_{ 0 };
+    int levels_{ 0 };
+
+    bool pyramid_valid_{ false };
+    glm::mat4 pyramid_view_projection_{ 1.0f };
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,555 @@
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+#include <brabbit/hull.hpp>
+#include <brabbit/parallel.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto GRAIN = std::size_t{ 1 << 15 };
+
+    // Outside points carry their position, so the sets are walked without touching `points`.
+    struct Candidate {
+      glm::vec3 position{ 0.0f, 0.0f, 0.0f };
+      std::uint32_t index{ INVALID_INDEX };
+    };
+
+    struct Face {
+      std::array<std::uint32_t, 3> vertices{};
+      std::array<std::uint32_t, 3> neighbors{};  // face across edge vertices[i] -> vertices[i + 1]
+      glm::vec3 normal{ 0.0f, 0.0f, 0.0f };
+      float offset{ 0.0f };
+
+      std::vector<Candidate> outside{};  // points above this face, owned by no other face
+      std::uint32_t furthest{ INVALID_INDEX };
+      float furthest_distance{ -std::numeric_limits<float>::infinity() };
+
+      std::uint32_t mark{ 0 };
+      bool visible{ false };
+      bool removed{ false };
+    };
+
+    struct Extreme {
+      float distance{ -std::numeric_limits<float>::infinity() };
+      std::uint32_t index{ INVALID_INDEX };
+    };
+
+    auto GetDistance(const Face& face, const glm::vec3& point) -> float {
+      return glm::dot(face.normal, point) - face.offset;
+    }
+
+    auto MakeFace(std::span<const glm::vec3> points,
+                  std::uint32_t a,
+                  std::uint32_t b,
+                  std::uint32_t c,
+                  const glm::vec3& fallback_normal) -> Face {
+      auto face = Face{};
+      face.vertices = { a, b, c };
+      face.neighbors = { INVALID_INDEX, INVALID_INDEX, INVALID_INDEX };
+
+      const auto normal = glm::cross(points[b] - points[a], points[c] - points[a]);
+      const auto length = glm::length(normal);
+      face.normal = length > 0.0f ? normal / length : fallback_normal;
+      face.offset = glm::dot(face.normal, points[a]);
+      return face;
+    }
+
+    // Point with the largest score, ties go to the lowest index so every run picks the same one.
+    template <typename _Function>
+    auto FindExtreme(std::size_t count, _Function&& score) -> Extreme {
+      auto partials = std::vector<Extreme>(GetParallelChunkCount(count, GRAIN));
+      ParallelFor(count, GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto& best = partials[chunk];
+        for (auto i = begin; i < end; ++i) {
+          const auto distance = score(i);
+          if (distance > best.distance) {
+            best = { distance, static_cast<std::uint32_t>(i) };
+          }
+        }
+      });
+
+      auto result = Extreme{};
+      for (const auto& partial : partials) {
+        if (partial.distance > result.distance) {
+          result = partial;
+        }
+      }
+      return result;
+    }
+
+    // Ball known to be inside every target face, points in it skip the face tests.
+    struct Core {
+      glm::vec3 center{ 0.0f, 0.0f, 0.0f };
+      float radius_squared{ -1.0f };
+    };
+
+    // Move `count` points into the outside sets of `targets`, each to the first face it is above.
+    // Chunks classify and count on their own, then scatter into exactly sized sets.
+    // candidate: (std::size_t i) -> Candidate
+    template <typename _Function>
+    auto AssignPoints(std::size_t count,
+                      _Function&& candidate,
+                      std::vector<Face>& faces,
+                      std::span<const std::uint32_t> targets,
+                      float epsilon,
+                      const Core& core = {}) -> void {
+      const auto face_count = targets.size();
+
+      // most fans only receive a handful of points, those skip the counting passes
+      if (count < GRAIN) {
+        for (const auto target : targets) {
+          faces[target].furthest = INVALID_INDEX;
+          faces[target].furthest_distance = -std::numeric_limits<float>::infinity();
+        }
+
+        for (auto i = std::size_t{ 0 }; i < count; ++i) {
+          const auto point = candidate(i);
+          const auto offset = point.position - core.center;
+          if (glm::dot(offset, offset) < core.radius_squared) {
+            continue;
+          }
+
+          for (auto slot = std::size_t{ 0 }; slot < face_count; ++slot) {
+            auto& face = faces[targets[slot]];
+            const auto distance = GetDistance(face, point.position);
+            if (distance > epsilon) {
+              face.outside.push_back(point);
+              if (distance > face.furthest_distance) {
+                face.furthest_distance = distance;
+                face.furthest = point.index;
+              }
+              break;
+            }
+          }
+        }
+        return;
+      }
+
+      const auto chunks = GetParallelChunkCount(count, GRAIN);
+      auto slots = std::vector<std::uint32_t>(count);
+      auto counts = std::vector<std::size_t>(chunks * face_count, 0);
+      auto extremes = std::vector<Extreme>(chunks * face_count);
+
+      ParallelFor(count, GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto* row_counts = counts.data() + chunk * face_count;
+        auto* row_extremes = extremes.data() + chunk * face_count;
+        for (auto i = begin; i < end; ++i) {
+          const auto [point, index] = candidate(i);
+
+          slots[i] = INVALID_INDEX;
+          const auto offset = point - core.center;
+          if (glm::dot(offset, offset) < core.radius_squared) {
+            continue;
+          }
+
+          for (auto slot = std::size_t{ 0 }; slot < face_count; ++slot) {
+            const auto distance = GetDistance(faces[targets[slot]], point);
+            if (distance > epsilon) {
+              slots[i] = static_cast<std::uint32_t>(slot);
+              ++row_counts[slot];
+              if (distance > row_extremes[slot].distance) {
+                row_extremes[slot] = { distance, index };
+              }
+              break;
+            }
+          }
+        }
+      });
+
+      auto offsets = std::vector<std::size_t>(chunks * face_count, 0);
+      for (auto slot = std::size_t{ 0 }; slot < face_count; ++slot) {
+        auto& face = faces[targets[slot]];
+        auto total = std::size_t{ 0 };
+        auto furthest = Extreme{};
+        for (auto chunk = std::size_t{ 0 }; chunk < chunks; ++chunk) {
+          offsets[chunk * face_count + slot] = total;
+          total += counts[chunk * face_count + slot];
+          if (extremes[chunk * face_count + slot].distance > furthest.distance) {
+            furthest = extremes[chunk * face_count + slot];
+          }
+        }
+
+        face.outside.resize(total);
+        face.furthest = furthest.index;
+        face.furthest_distance = furthest.distance;
+      }
+
+      ParallelFor(count, GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto* row = offsets.data() + chunk * face_count;
+        for (auto i = begin; i < end; ++i) {
+          if (slots[i] != INVALID_INDEX) {
+            faces[targets[slots[i]]].outside[row[slots[i]]++] = candidate(i);
+          }
+        }
+      });
+    }
+
+    auto LinkFaces(std::vector<Face>& faces) -> void {
+      for (auto& face : faces) {
+        for (auto edge = 0; edge < 3; ++edge) {
+          const auto from = face.vertices[edge];
+          const auto to = face.vertices[(edge + 1) % 3];
+          for (auto other = std::uint32_t{ 0 }; other < faces.size(); ++other) {
+            const auto& vertices = faces[other].vertices;
+            for (auto i = 0; i < 3; ++i) {
+              if (vertices[i] == to && vertices[(i + 1) % 3] == from) {
+                face.neighbors[edge] = other;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Directions of the extreme points, one per axis of a cube, its edges and its corners.
+    constexpr auto DIRECTIONS = std::array<glm::vec3, 13>{ {
+      { 1.0f, 0.0f, 0.0f },   { 0.0f, 1.0f, 0.0f },  { 0.0f, 0.0f, 1.0f },  { 1.0f, 1.0f, 0.0f },
+      { 1.0f, -1.0f, 0.0f },  { 1.0f, 0.0f, 1.0f },  { 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 1.0f },
+      { 0.0f, 1.0f, -1.0f },  { 1.0f, 1.0f, 1.0f },  { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f },
+      { 1.0f, -1.0f, -1.0f },
+    } };
+
+    // Highest and lowest point along every direction, in one parallel pass. Duplicates are kept.
+    auto FindExtremes(std::span<const glm::vec3> points) -> std::vector<std::uint32_t> {
+      using Bounds = std::array<std::pair<Extreme, Extreme>, DIRECTIONS.size()>;
+      auto partials = std::vector<Bounds>(GetParallelChunkCount(points.size(), GRAIN));
+      ParallelFor(points.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+        auto& bounds = partials[chunk];
+        for (auto i = begin; i < end; ++i) {
+          for (auto direction = std::size_t{ 0 }; direction < DIRECTIONS.size(); ++direction) {
+            const auto distance = glm::dot(points[i], DIRECTIONS[direction]);
+            auto& [high, low] = bounds[direction];
+            if (distance > high.distance) {
+              high = { distance, static_cast<std::uint32_t>(i) };
+            }
+            if (-distance > low.distance) {
+              low = { -distance, static_cast<std::uint32_t>(i) };
+            }
+          }
+        }
+      });
+
+      auto extremes = std::vector<std::uint32_t>(DIRECTIONS.size() * 2);
+      for (auto direction = std::size_t{ 0 }; direction < DIRECTIONS.size(); ++direction) {
+        auto high = Extreme{};
+        auto low = Extreme{};
+        for (const auto& bounds : partials) {
+          if (bounds[direction].first.distance > high.distance) {
+            high = bounds[direction].first;
+          }
+          if (bounds[direction].second.distance > low.distance) {
+            low = bounds[direction].second;
+          }
+        }
+        extremes[direction * 2] = high.index;
+        extremes[direction * 2 + 1] = low.index;
+      }
+      return extremes;
+    }
+
+    // Expand the hull towards the furthest point of one face at a time. Visible faces are found by
+    // walking neighbors from that face, the horizon around them is fanned to the new point and
+    // the points of the removed faces are handed to the new fan.
+    auto Expand(std::span<const glm::vec3> points,
+                std::vector<Face>& faces,
+                std::vector<std::uint32_t> pending,
+                float epsilon) -> void {
+      struct Horizon {
+        std::uint32_t from{};
+        std::uint32_t to{};
+        std::uint32_t neighbor{};
+      };
+
+      // marks left by an earlier expansion would alias the new ones
+      for (auto& face : faces) {
+        face.mark = 0;
+      }
+
+      auto mark = std::uint32_t{ 0 };
+      auto targets = std::vector<std::uint32_t>{};
+      auto visible = std::vector<std::uint32_t>{};
+      auto stack = std::vector<std::uint32_t>{};
+      auto horizon = std::vector<Horizon>{};
+      auto orphans = std::vector<Candidate>{};
+      auto starts = std::unordered_map<std::uint32_t, std::uint32_t>{};
+      auto ends = std::unordered_map<std::uint32_t, std::uint32_t>{};
+
+      while (!pending.empty()) {
+        const auto current = pending.back();
+        pending.pop_back();
+        if (faces[current].removed || faces[current].outside.empty()) {
+          continue;
+        }
+
+        const auto eye = faces[current].furthest;
+        const auto& eye_point = points[eye];
+
+        ++mark;
+        visible.clear();
+        horizon.clear();
+        faces[current].mark = mark;
+        faces[current].visible = true;
+        stack.assign(1, current);
+        while (!stack.empty()) {
+          const auto face = stack.back();
+          stack.pop_back();
+          visible.push_back(face);
+
+          for (auto edge = 0; edge < 3; ++edge) {
+            const auto neighbor = faces[face].neighbors[edge];
+            if (neighbor == INVALID_INDEX) {
+              continue;
+            }
+
+            auto& other = faces[neighbor];
+            if (other.mark != mark) {
+              other.mark = mark;
+              // anything the eye is above counts, keeping nearly coplanar neighbors out of the fan
+              other.visible = GetDistance(other, eye_point) > 0.0f;
+              if (other.visible) {
+                stack.push_back(neighbor);
+                continue;
+              }
+            }
+
+            if (!other.visible) {
+              horizon.push_back({ faces[face].vertices[edge],
+                                  faces[face].vertices[(edge + 1) % 3],
+                                  neighbor });
+            }
+          }
+        }
+
+        // Rounding can leave a visible region that is not a disk or that covers every face, its
+        // horizon is then not a single loop. The eye is dropped in that case, it lies within
+        // rounding of the hull anyway.
+        starts.clear();
+        ends.clear();
+        auto simple = !horizon.empty();
+        for (auto i = std::uint32_t{ 0 }; i < horizon.size() && simple; ++i) {
+          const auto index = static_cast<std::uint32_t>(faces.size()) + i;
+          simple = starts.emplace(horizon[i].from, index).second &&
+                   ends.emplace(horizon[i].to, index).second;
+        }
+        if (simple) {
+          auto length = std::size_t{ 0 };
+          auto vertex = horizon.front().to;
+          while (vertex != horizon.front().from && starts.contains(vertex) &&
+                 length < horizon.size()) {
+            vertex = horizon[starts[vertex] - faces.size()].to;
+            ++length;
+          }
+          simple = vertex == horizon.front().from && length + 1 == horizon.size();
+        }
+
+        if (!simple) {
+          auto& face = faces[current];
+          std::erase_if(face.outside, [eye](const auto& point) { return point.index == eye; });
+          face.furthest = INVALID_INDEX;
+          face.furthest_distance = -std::numeric_limits<float>::infinity();
+          for (const auto& point : face.outside) {
+            const auto distance = GetDistance(face, point.position);
+            if (distance > face.furthest_distance) {
+              face.furthest_distance = distance;
+              face.furthest = point.index;
+            }
+          }
+          pending.push_back(current);
+          continue;
+        }
+
+        // fan the horizon to the eye, stitching each new face to the hidden side of its edge
+        targets.clear();
+        for (const auto& edge : horizon) {
+          const auto index = static_cast<std::uint32_t>(faces.size());
+          auto face = MakeFace(points, edge.from, edge.to, eye, faces[edge.neighbor].normal);
+          face.neighbors[0] = edge.neighbor;
+
+          auto& neighbor = faces[edge.neighbor];
+          for (auto i = 0; i < 3; ++i) {
+            if (neighbor.vertices[i] == edge.to && neighbor.vertices[(i + 1) % 3] == edge.from) {
+              neighbor.neighbors[i] = index;
+            }
+          }
+
+          targets.push_back(index);
+          faces.push_back(std::move(face));
+        }
+
+        for (const auto index : targets) {
+          auto& face = faces[index];
+          if (auto iter = starts.find(face.vertices[1]); iter != starts.end()) {
+            face.neighbors[1] = iter->second;
+          }
+          if (auto iter = ends.find(face.vertices[0]); iter != ends.end()) {
+            face.neighbors[2] = iter->second;
+          }
+        }
+
+        orphans.clear();
+        for (const auto face : visible) {
+          auto& removed = faces[face];
+          removed.removed = true;
+          for (const auto& point : removed.outside) {
+            if (point.index != eye) {
+              orphans.push_back(point);
+            }
+          }
+          std::vector<Candidate>{}.swap(removed.outside);
+        }
+
+        AssignPoints(
+            orphans.size(), [&](auto i) { return orphans[i]; }, faces, targets, epsilon);
+
+        for (const auto index : targets) {
+          if (!faces[index].outside.empty()) {
+            pending.push_back(index);
+          }
+        }
+      }
+    }
+
+  }  // namespace
+
+  auto ComputeConvexHull(std::span<const glm::vec3> points) -> std::unique_ptr<Mesh> {
+    const auto count = points.size();
+    if (count < 4 || count >= INVALID_INDEX) {
+      return nullptr;
+    }
+
+    // extremes along the axes come first, they give the tolerance of plane distances
+    const auto extremes = FindExtremes(points);
+    auto scale = 0.0f;
+    for (auto axis = 0; axis < 3; ++axis) {
+      scale += std::max(std::abs(points[extremes[axis * 2]][axis]),
+                        std::abs(points[extremes[axis * 2 + 1]][axis]));
+    }
+    const auto epsilon = 3.0f * FLT_EPSILON * scale;
+
+    // Initial tetrahedron: the widest pair of extremes, the point furthest from their line and the
+    // point furthest from the plane of the three.
+    auto a = extremes[0];
+    auto b = extremes[1];
+    for (auto i = std::size_t{ 0 }; i < extremes.size(); ++i) {
+      for (auto j = i + 1; j < extremes.size(); ++j) {
+        const auto distance = glm::length(points[extremes[i]] - points[extremes[j]]);
+        if (distance > glm::length(points[a] - points[b])) {
+          a = extremes[i];
+          b = extremes[j];
+        }
+      }
+    }
+    if (glm::length(points[a] - points[b]) <= epsilon) {
+      return nullptr;
+    }
+
+    const auto direction = glm::normalize(points[b] - points[a]);
+    const auto c_extreme = FindExtreme(count, [&](auto i) {
+      return glm::length(glm::cross(points[i] - points[a], direction));
+    });
+    if (c_extreme.distance <= epsilon) {
+      return nullptr;
+    }
+    const auto c = c_extreme.index;
+
+    const auto base_normal = glm::normalize(glm::cross(points[b] - points[a], points[c] - points[a]));
+    const auto d_extreme = FindExtreme(count, [&](auto i) {
+      return std::abs(glm::dot(points[i] - points[a], base_normal));
+    });
+    if (d_extreme.distance <= epsilon) {
+      return nullptr;
+    }
+    const auto d = d_extreme.index;
+
+    // wind every face so the opposite corner is below it
+    auto faces = std::vector<Face>{};
+    const auto corners = std::array{ a, b, c, d };
+    const auto centroid = (points[a] + points[b] + points[c] + points[d]) * 0.25f;
+    for (auto skip = 0; skip < 4; ++skip) {
+      auto face = std::array<std::uint32_t, 3>{};
+      for (auto i = 0, n = 0; i < 4; ++i) {
+        if (i != skip) {
+          face[n++] = corners[i];
+        }
+      }
+
+      auto created = MakeFace(points, face[0], face[1], face[2], base_normal);
+      if (GetDistance(created, centroid) > 0.0f) {
+        created = MakeFace(points, face[0], face[2], face[1], base_normal);
+      }
+      faces.push_back(std::move(created));
+    }
+    LinkFaces(faces);
+
+    // The hull of the extremes alone is a cheap polytope that already contains most of the
+    // points, one parallel pass over it drops them before the sequential expansion starts.
+    const auto alive = [&faces] {
+      auto indices = std::vector<std::uint32_t>{};
+      for (auto i = std::uint32_t{ 0 }; i < faces.size(); ++i) {
+        if (!faces[i].removed) {
+          indices.push_back(i);
+        }
+      }
+      return indices;
+    };
+
+    auto targets = alive();
+    AssignPoints(
+        extremes.size(),
+        [&](auto i) { return Candidate{ points[extremes[i]], extremes[i] }; },
+        faces,
+        targets,
+        epsilon);
+    Expand(points, faces, targets, epsilon);
+
+    targets = alive();
+    auto core = Core{};
+    for (const auto index : extremes) {
+      core.center += points[index] / static_cast<float>(extremes.size());
+    }
+    auto radius = std::numeric_limits<float>::infinity();
+    for (const auto index : targets) {
+      radius = std::min(radius, -GetDistance(faces[index], core.center));
+    }
+    if (radius > 0.0f) {
+      core.radius_squared = radius * radius;
+    }
+
+    AssignPoints(
+        count,
+        [&](auto i) { return Candidate{ points[i], static_cast<std::uint32_t>(i) }; },
+        faces,
+        targets,
+        epsilon,
+        core);
+    Expand(points, faces, targets, epsilon);
+
+    auto vertices = std::vector<glm::vec3>{};
+    auto normals = std::vector<glm::vec3>{};
+    auto indices = std::vector<glm::uvec3>{};
+    for (const auto& face : faces) {
+      if (face.removed) {
+        continue;
+      }
+
+      const auto first = static_cast<glm::uint>(vertices.size());
+      indices.emplace_back(first, first + 1, first + 2);
+      for (const auto index : face.vertices) {
+        vertices.push_back(points[index]);
+        normals.push_back(face.normal);
+      }
+    }
+
+    return std::make_unique<Mesh>(std::move(vertices), std::move(normals), std::move(indices));
+  }
+
+  auto ComputeConvexHull(const Mesh& mesh) -> std::unique_ptr<Mesh> {
+    return ComputeConvexHull(std::span<const glm::vec3>{ mesh.getVertices() });
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <span>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/mesh.hpp>
+
+namespace brabbit {
+
+  // Convex hull of a point cloud by Quickhull, nullptr when the points are flat or fewer than 4.
+  // Every hull face gets its own 3 vertices and face normal, so the result draws flat shaded as a
+  // Model. Points closer than a relative epsilon to a face count as inside the hull.
+  auto ComputeConvexHull(std::span<const glm::vec3> points) -> std::unique_ptr<Mesh>;
+
+  auto ComputeConvexHull(const Mesh& mesh) -> std::unique_ptr<Mesh>;
+
+}  // namespace brabbit
@@ -0,0 +1,323 @@
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <brabbit/camera.hpp>
+#include <brabbit/depth_shader.hpp>
+#include <brabbit/gpu_culler.hpp>
+#include <brabbit/instance_batcher.hpp>
+#include <brabbit/model.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/shader_registry.hpp>
+#include <brabbit/upload_ring.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    // frames between visible sample counts while the pre-pass is off
+    constexpr auto OVERDRAW_INTERVAL = std::size_t{ 30 };
+
+  }  // namespace
+
+  InstanceBatcher::InstanceBatcher() {
+    for (auto* buffer : { &instance_buffer_,
+                          &command_buffer_,
+                          &instance_command_buffer_,
+                          &bounds_buffer_,
+                          &visible_buffer_ }) {
+      glCreateBuffers(1, &buffer->id);
+    }
+  }
+
+  InstanceBatcher::~InstanceBatcher() {
+    auto& state = GetRenderState();
+    for (auto* buffer : { &instance_buffer_,
+                          &command_buffer_,
+                          &instance_command_buffer_,
+                          &bounds_buffer_,
+                          &visible_buffer_ }) {
+      state.forgetBuffer(buffer->id);
+      glDeleteBuffers(1, &buffer->id);
+    }
+  }
+
+  auto InstanceBatcher::isIndirect() const -> bool {
+    return indirect_;
+  }
+
+  auto InstanceBatcher::setIndirect(bool indirect) -> void {
+    indirect_ = indirect;
+  }
+
+  auto InstanceBatcher::isCulling() const -> bool {
+    return culling_;
+  }
+
+  auto InstanceBatcher::setCulling(bool culling) -> void {
+    culling_ = culling;
+  }
+
+  auto InstanceBatcher::getCuller() -> GpuCuller* {
+    return culler_.get();
+  }
+
+  auto InstanceBatcher::getObjects() -> ObjectBuffer& {
+    return objects_;
+  }
+
+  auto InstanceBatcher::add(Model& model, const GeometryRange& range, std::uint32_t object)
+      -> void {
+    const auto* shader = static_cast<const Shader*>(model.getShader());
+    const auto key = std::pair{ &range, shader };
+    const auto [iter, inserted] = lookup_.try_emplace(key, groups_.size());
+    if (inserted) {
+      const auto [bucket, added] = bucket_lookup_.try_emplace(shader, buckets_.size());
+      if (added) {
+        buckets_.emplace_back();
+      }
+      ++buckets_[bucket->second].count;
+      groups_.push_back(Group{ &model, &range, bucket->second });
+    }
+
+    ++groups_[iter->second].count;
+    entries_.push_back(Entry{ iter->second, object });
+  }
+
+  auto InstanceBatcher::flush(const Camera* camera) -> void {
+    objects_.upload(camera ? camera->getProjection() * camera->getView() : glm::mat4{ 1.0f });
+
+    call_count_ = 0;
+    draw_count_ = groups_.size();
+    instance_count_ = entries_.size();
+
+    // counting sort of the groups by bucket, then of the instances by group, so every bucket is
+    // a run of commands and every group a run of instances for its base instance
+    auto first = std::size_t{ 0 };
+    for (auto& bucket : buckets_) {
+      bucket.first = first;
+      first += bucket.count;
+    }
+
+    order_.resize(groups_.size());
+    auto bucket_cursor = std::vector<std::size_t>(buckets_.size());
+    for (auto i = std::size_t{ 0 }; i < buckets_.size(); ++i) {
+      bucket_cursor[i] = buckets_[i].first;
+    }
+    for (auto i = std::size_t{ 0 }; i < groups_.size(); ++i) {
+      order_[bucket_cursor[groups_[i].bucket]++] = i;
+    }
+
+    first = 0;
+    for (auto index : order_) {
+      groups_[index].first = first;
+      first += groups_[index].count;
+    }
+
+    instances_.resize(entries_.size());
+    auto cursor = std::vector<std::size_t>(groups_.size());
+    for (auto i = std::size_t{ 0 }; i < groups_.size(); ++i) {
+      cursor[i] = groups_[i].first;
+    }
+    for (const auto& entry : entries_) {
+      instances_[cursor[entry.group]++] = entry.object;
+    }
+
+    auto* arena = GetGeometryArena();
+    if (arena && !instances_.empty()) {
+      UploadBuffer(instance_buffer_, instances_);
+      arena->setInstanceBuffer(instance_buffer_.id);
+
+      if (indirect_) {
+        prepareIndirect(*arena, camera);
+      }
+      drawPasses(*arena);
+    }
+
+    lookup_.clear();
+    bucket_lookup_.clear();
+    groups_.clear();
+    buckets_.clear();
+    entries_.clear();
+  }
+
+  auto InstanceBatcher::captureDepth(const Camera& camera) -> void {
+    if (culler_) {
+      const auto size = glm::ivec2{ camera.getSize() };
+      culler_->updateDepthPyramid(size, camera.getProjection() * camera.getView());
+    }
+  }
+
+  auto InstanceBatcher::isDepthPrepass() const -> bool {
+    return depth_prepass_;
+  }
+
+  auto InstanceBatcher::setDepthPrepass(bool depth_prepass) -> void {
+    depth_prepass_ = depth_prepass;
+  }
+
+  auto InstanceBatcher::getOverdrawFactor() const -> float {
+    return overdraw_.getFactor();
+  }
+
+  auto InstanceBatcher::getCallCount() const -> std::size_t {
+    return call_count_;
+  }
+
+  auto InstanceBatcher::getDrawCount() const -> std::size_t {
+    return draw_count_;
+  }
+
+  auto InstanceBatcher::getInstanceCount() const -> std::size_t {
+    return instance_count_;
+  }
+
+  auto InstanceBatcher::PrepareBuffer(StreamBuffer& buffer, std::size_t size) -> void {
+    // a fresh allocation or an invalidation lets the driver hand out new storage
+    if (size > buffer.capacity) {
+      buffer.capacity = std::max(size, buffer.capacity + buffer.capacity / 2);
+      glNamedBufferData(
+          buffer.id, static_cast<GLsizeiptr>(buffer.capacity), nullptr, GL_STREAM_DRAW);
+    } else {
+      glInvalidateBufferData(buffer.id);
+    }
+  }
+
+  template <typename _Type>
+  auto InstanceBatcher::UploadBuffer(StreamBuffer& buffer, const std::vector<_Type>& data)
+      -> void {
+    const auto size = data.size() * sizeof(_Type);
+    PrepareBuffer(buffer, size);
+    UploadBufferData(buffer.id, 0, data.data(), size);
+  }
+
+  auto InstanceBatcher::prepareIndirect(GeometryArena& arena, const Camera* camera) -> void {
+    if (culling_ && camera && !culler_) {
+      culler_ = std::make_unique<GpuCuller>();
+    }
+    const auto culled = culling_ && camera && culler_->isReady();
+
+    commands_.clear();
+    for (auto index : order_) {
+      const auto& group = groups_[index];
+      commands_.push_back(arena.getDrawCommand(*group.range, group.first, group.count));
+    }
+
+    if (culled) {
+      // the cull pass counts the survivors
+      instance_commands_.resize(instances_.size());
+      command_bounds_.clear();
+      for (auto command = std::size_t{ 0 }; command < order_.size(); ++command) {
+        const auto& group = groups_[order_[command]];
+        std::fill_n(instance_commands_.begin() + group.first,
+                    group.count,
+                    static_cast<std::uint32_t>(command));
+
+        const auto bounds = group.model->getBounds();
+        command_bounds_.push_back(Bounds{ glm::vec4{ bounds.min, 1.0f },
+                                          glm::vec4{ bounds.max, 1.0f } });
+        commands_[command].instance_count = 0;
+      }
+
+      UploadBuffer(instance_command_buffer_, instance_commands_);
+      UploadBuffer(bounds_buffer_, command_bounds_);
+      PrepareBuffer(visible_buffer_, instances_.size() * sizeof(std::uint32_t));
+    }
+
+    UploadBuffer(command_buffer_, commands_);
+
+    if (culled) {
+      const auto buffers = CullBuffers{ instance_buffer_.id,
+                                        instance_command_buffer_.id,
+                                        bounds_buffer_.id,
+                                        command_buffer_.id,
+                                        visible_buffer_.id,
+                                        instances_.size() };
+      culler_->cull(buffers);
+      arena.setInstanceBuffer(visible_buffer_.id);
+    }
+
+    GetRenderState().bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_.id);
+  }
+
+  auto InstanceBatcher::drawPasses(GeometryArena& arena) -> void {
+    auto& state = GetRenderState();
+
+    // lazily compiled, the frames before it is ready draw without a pre-pass
+    const auto measure = ++frame_ % OVERDRAW_INTERVAL == 0;
+    auto* depth_shader = depth_prepass_ || measure ? LoadCachedShader<DepthShader>() : nullptr;
+    const auto depth_ready = depth_shader && depth_shader->isReady();
+
+    if (depth_prepass_ && depth_ready) {
+      // the pre-pass shades nothing, so what passes its depth test is what would have been shaded
+      state.setColorMask(false);
+      overdraw_.begin(OverdrawMeter::Count::SHADED);
+      drawDepth(arena, *depth_shader);
+      overdraw_.end();
+      state.setColorMask(true);
+
+      state.setDepthMask(false);
+      state.setDepthFunc(GL_EQUAL);
+      overdraw_.begin(OverdrawMeter::Count::VISIBLE);
+      drawColor();
+      overdraw_.end();
+      state.setDepthFunc(GL_LESS);
+      state.setDepthMask(true);
+    } else {
+      overdraw_.begin(OverdrawMeter::Count::SHADED);
+      drawColor();
+      overdraw_.end();
+
+      // without a pre-pass the visible samples take a depth only pass of their own, now and then
+      if (measure && depth_ready) {
+        state.setColorMask(false);
+        state.setDepthMask(false);
+        state.setDepthFunc(GL_EQUAL);
+        overdraw_.begin(OverdrawMeter::Count::VISIBLE);
+        drawDepth(arena, *depth_shader);
+        overdraw_.end();
+        state.setDepthFunc(GL_LESS);
+        state.setDepthMask(true);
+        state.setColorMask(true);
+      }
+    }
+
+    overdraw_.endFrame();
+  }
+
+  auto InstanceBatcher::drawColor() -> void {
+    if (indirect_) {
+      for (const auto& bucket : buckets_) {
+        const auto& group = groups_[order_[bucket.first]];
+        group.model->drawIndirect(bucket.first, bucket.count);
+        ++call_count_;
+      }
+      return;
+    }
+
+    for (auto index : order_) {
+      const auto& group = groups_[index];
+      group.model->drawInstances(group.first, group.count);
+      ++call_count_;
+    }
+  }
+
+  auto InstanceBatcher::drawDepth(GeometryArena& arena, DepthShader& shader) -> void {
+    shader.use();
+    GetRenderState().bindVertexArray(arena.getDepthVao());
+
+    // one program for every bucket, so all commands go in one call
+    if (indirect_) {
+      arena.drawIndirect(0, commands_.size());
+      ++call_count_;
+      return;
+    }
+
+    for (auto index : order_) {
+      const auto& group = groups_[index];
+      arena.draw(*group.range, group.first, group.count);
+      ++call_count_;
+    }
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <brabbit/geometry_arena.hpp>
+#include <brabbit/object_buffer.hpp>
+#include <brabbit/overdraw_meter.hpp>
+
+namespace brabbit {
+
+  class Camera;
+  class DepthShader;
+  class GpuCuller;
+  class Model;
+  class Shader;
+
+  // Collects the models of a frame and draws all instances of the same arena range and shader
+  // with one instanced draw. Instances are object indices in a single buffer, group after group,
+  // the objects themselves go to the ObjectBuffer of the batcher.
+  //
+  // Indirect submission writes one DrawElementsIndirectCommand per group instead and draws every
+  // group of a shader with one glMultiDrawElementsIndirect, so the CPU cost of a frame depends on
+  // the number of shaders, not on the number of meshes. With culling on, the instance counts of
+  // the commands are left to a GpuCuller pass.
+  class InstanceBatcher {
+   public:
+    explicit InstanceBatcher();
+    virtual ~InstanceBatcher();
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    auto operator=(const InstanceBatcher&) -> InstanceBatcher& = delete;
+
+   public:
+    // On by default, off issues one instanced draw per group.
+    auto isIndirect() const -> bool;
+    auto setIndirect(bool indirect) -> void;
+
+    // On by default, only takes effect on indirect submission.
+    auto isCulling() const -> bool;
+    auto setCulling(bool culling) -> void;
+
+    // Created with the first culled flush.
+    auto getCuller() -> GpuCuller*;
+
+    // Off by default. On draws the batched geometry into depth alone first, with positions only,
+    // then shades it with an equal depth test and depth writes off, so every visible sample is
+    // shaded once however much the models overlap.
+    auto isDepthPrepass() const -> bool;
+    auto setDepthPrepass(bool depth_prepass) -> void;
+
+    // Samples shaded per visible sample in the batched draws, measured with the pre-pass on or
+    // off. Well above 1 means fragment work the pre-pass would save, see OverdrawMeter.
+    auto getOverdrawFactor() const -> float;
+
+   public:
+    // Objects of the frame, models that draw themselves add theirs here too.
+    auto getObjects() -> ObjectBuffer&;
+
+    auto add(Model& model, const GeometryRange& range, std::uint32_t object) -> void;
+
+    // Upload the objects and instances and draw every shader in the order it was first added,
+    // then start over. The objects are left bound for the models that draw themselves. The
+    // camera is needed for culling, without one everything is drawn.
+    auto flush(const Camera* camera = nullptr) -> void;
+
+    // Keep the depth of the finished frame for the next frame's occlusion culling.
+    auto captureDepth(const Camera& camera) -> void;
+
+    // Draw calls issued, draws (groups) and instances before culling of the last flush.
+    auto getCallCount() const -> std::size_t;
+    auto getDrawCount() const -> std::size_t;
+    auto getInstanceCount() const -> std::size_t;
+
+   private:
+    struct Group {
+      Model* model{ nullptr };  // the first one added, draws the whole group
+      const GeometryRange* range{ nullptr };
+      std::size_t bucket{ 0 };
+      std::size_t first{ 0 };  // into the instance buffer
+      std::size_t count{ 0 };
+    };
+
+    // groups sharing a shader, everything else about the arena draws is the same
+    struct Bucket {
+      std::size_t first{ 0 };  // into order_, and the command buffer
+      std::size_t count{ 0 };
+    };
+
+    struct Entry {
+      std::size_t group{ 0 };
+      std::uint32_t object{ 0 };
+    };
+
+    struct Bounds {
+      glm::vec4 min{ 0.0f };
+      glm::vec4 max{ 0.0f };
+    };
+
+    // Buffer rewritten every flush, grown when it is too small.
+    struct StreamBuffer {
+      unsigned int id{ 0 };
+      std::size_t capacity{ 0 };  // in bytes
+    };
+
+   private:
+    // Make room for size bytes, last frame's draws may still read the old contents.
+    static auto PrepareBuffer(StreamBuffer& buffer, std::size_t size) -> void;
+
+    template <typename _Type>
+    static auto UploadBuffer(StreamBuffer& buffer, const std::vector<_Type>& data) -> void;
+
+    // Commands, and their culling, for indirect draws of the flush.
+    auto prepareIndirect(GeometryArena& arena, const Camera* camera) -> void;
+
+    auto drawPasses(GeometryArena& arena) -> void;
+    auto drawColor() -> void;
+    auto drawDepth(GeometryArena& arena, DepthShader& shader) -> void;
+
+   private:
+    bool indirect_{ true };
+    bool culling_{ true };
+    std::unique_ptr<GpuCuller> culler_{ nullptr };
+
+    bool depth_prepass_{ false };
+    OverdrawMeter overdraw_{};
+    std::size_t frame_{ 0 };
+
+    ObjectBuffer objects_{};
+
+    std::map<std::pair<const GeometryRange*, const Shader*>, std::size_t> lookup_{};
+    std::map<const Shader*, std::size_t> bucket_lookup_{};
+    std::vector<Group> groups_{};
+    std::vector<Bucket> buckets_{};
+    std::vector<std::size_t> order_{};  // groups by bucket
+    std::vector<Entry> entries_{};
+    std::vector<std::uint32_t> instances_{};
+    std::vector<DrawElementsIndirectCommand> commands_{};
+    std::vector<std::uint32_t> instance_commands_{};
+    std::vector<Bounds> command_bounds_{};
+
+    StreamBuffer instance_buffer_{};
+    StreamBuffer command_buffer_{};
+    StreamBuffer instance_command_buffer_{};
+    StreamBuffer bounds_buffer_{};
+    StreamBuffer visible_buffer_{};
+
+    std::size_t call_count_{ 0 };
+    std::size_t draw_count_{ 0 };
+    std::size_t instance_count_{ 0 };
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#include <brabbit/instancing.hpp>
+#include <brabbit/parallel.hpp>
+#include <brabbit/resource_pack.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    // Relative gap between covariance eigenvalues below which principal axes are unreliable,
+    // symmetric parts such as bolts fall back to frames spanned by anchor vertices.
+    constexpr auto AXIS_GAP = 1e-3;
+
+    // Cell size of the coarse shape key and how far, in tolerances, the shape of a match can be
+    // off. Cells grow with the tolerance so a match is never more than half a cell away.
+    constexpr auto SHAPE_CELL = 1.0 / 64.0;
+    constexpr auto SHAPE_DRIFT = 8.0;
+
+    // Rigid-invariant description of a part, its shape in the principal frame.
+    struct Signature {
+      std::uint64_t topology{ 0 };
+      glm::dvec3 shape{ 0.0 };  // log2 of the size, largest two spreads relative to the size
+      glm::dvec3 centroid{ 0.0 };
+      glm::dvec3 spectrum{ 0.0 };  // covariance eigenvalues, descending
+      glm::dmat3 axes{ 1.0 };      // matching eigenvectors as columns
+    };
+
+    // First part of a group. Candidates build their frame from the same vertex indices.
+    struct Representative {
+      std::size_t part{ 0 };
+      std::size_t mesh{ 0 };
+      bool principal{ false };
+      std::array<std::size_t, 2> anchors{};
+    };
+
+    constexpr auto FNV_OFFSET = std::uint64_t{ 0xCBF29CE484222325 };
+
+    auto MixHash(std::uint64_t& hash, std::uint32_t value) -> void {
+      for (auto byte = 0; byte < 4; ++byte) {
+        hash = (hash ^ ((value >> (byte * 8)) & 0xFF)) * 0x100000001B3;
+      }
+    }
+
+    // FNV-1a over the triangle list and vertex count, equal for copies of the same export.
+    auto HashTopology(const Mesh& mesh) -> std::uint64_t {
+      auto hash = FNV_OFFSET;
+      MixHash(hash, static_cast<std::uint32_t>(mesh.getVertices().size()));
+      for (const auto& triangle : mesh.getIndices()) {
+        MixHash(hash, triangle.x);
+        MixHash(hash, triangle.y);
+        MixHash(hash, triangle.z);
+      }
+      return hash;
+    }
+
+    // Bucket of a topology and a shape cell. Unwelded parts with the same facet count share the
+    // topology, the shape cell keeps them apart unless they are also about the same shape.
+    auto GetBucketKey(std::uint64_t topology, const glm::ivec3& cell) -> std::uint64_t {
+      auto hash = FNV_OFFSET;
+      MixHash(hash, static_cast<std::uint32_t>(topology));
+      MixHash(hash, static_cast<std::uint32_t>(topology >> 32));
+      MixHash(hash, static_cast<std::uint32_t>(cell.x));
+      MixHash(hash, static_cast<std::uint32_t>(cell.y));
+      MixHash(hash, static_cast<std::uint32_t>(cell.z));
+      return hash;
+    }
+
+    // Eigen decomposition of a symmetric 3x3 matrix by cyclic Jacobi rotations.
+    auto DecomposeSymmetric(glm::dmat3 matrix, glm::dvec3& values, glm::dmat3& vectors) -> void {
+      constexpr auto PAIRS = std::array<std::array<int, 2>, 3>{ { { 0, 1 }, { 0, 2 }, { 1, 2 } } };
+
+      vectors = glm::dmat3{ 1.0 };
+      for (auto sweep = 0; sweep < 32; ++sweep) {
+        const auto diagonal = matrix[0][0] * matrix[0][0] + matrix[1][1] * matrix[1][1] +
+                              matrix[2][2] * matrix[2][2];
+        const auto off = matrix[1][0] * matrix[1][0] + matrix[2][0] * matrix[2][0] +
+                         matrix[2][1] * matrix[2][1];
+        if (off <= diagonal * 1e-30) {
+          break;
+        }
+
+        for (const auto& [p, q] : PAIRS) {
+          if (matrix[q][p] == 0.0) {
+            continue;
+          }
+
+          // rotation in the pq plane zeroing the pq element (Golub and Van Loan 8.5.2)
+          const auto theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[q][p]);
+          const auto t = std::copysign(1.0, theta) / (std::abs(theta) + std::hypot(theta, 1.0));
+          const auto c = 1.0 / std::hypot(t, 1.0);
+          const auto s = t * c;
+
+          auto rotation = glm::dmat3{ 1.0 };
+          rotation[p][p] = c;
+          rotation[q][q] = c;
+          rotation[q][p] = s;
+          rotation[p][q] = -s;
+          matrix = glm::transpose(rotation) * matrix * rotation;
+          vectors = vectors * rotation;
+        }
+      }
+
+      auto order = std::array<int, 3>{ 0, 1, 2 };
+      std::sort(order.begin(), order.end(), [&matrix](int a, int b) {
+        return matrix[a][a] > matrix[b][b];
+      });
+
+      const auto unsorted = vectors;
+      for (auto i = 0; i < 3; ++i) {
+        values[i] = std::max(0.0, matrix[order[i]][order[i]]);
+        vectors[i] = unsorted[order[i]];
+      }
+    }
+
+    auto ComputeSignature(const Mesh& mesh) -> Signature {
+      const auto& vertices = mesh.getVertices();
+      auto signature = Signature{};
+      signature.topology = HashTopology(mesh);
+      if (vertices.empty()) {
+        return signature;
+      }
+
+      for (const auto& vertex : vertices) {
+        signature.centroid += glm::dvec3{ vertex };
+      }
+      signature.centroid /= static_cast<double>(vertices.size());
+
+      auto covariance = glm::dmat3{ 0.0 };
+      for (const auto& vertex : vertices) {
+        const auto offset = glm::dvec3{ vertex } - signature.centroid;
+        covariance += glm::outerProduct(offset, offset);
+      }
+      covariance /= static_cast<double>(vertices.size());
+
+      DecomposeSymmetric(covariance, signature.spectrum, signature.axes);
+
+      const auto& spectrum = signature.spectrum;
+      const auto size = std::sqrt(spectrum[0] + spectrum[1] + spectrum[2]);
+      if (size > 0.0) {
+        signature.shape = { std::log2(size),
+                            std::sqrt(spectrum[0]) / size,
+                            std::sqrt(spectrum[1]) / size };
+      }
+      return signature;
+    }
+
+    // Any unit vector perpendicular to a unit vector.
+    auto GetPerpendicular(const glm::dvec3& axis) -> glm::dvec3 {
+      const auto other = std::abs(axis.x) < 0.5 ? glm::dvec3{ 1.0, 0.0, 0.0 }
+                                                : glm::dvec3{ 0.0, 1.0, 0.0 };
+      return glm::normalize(glm::cross(axis, other));
+    }
+
+    auto MakeRepresentative(const Mesh& mesh,
+                            const Signature& signature,
+                            std::size_t part,
+                            std::size_t mesh_index) -> Representative {
+      const auto& vertices = mesh.getVertices();
+      const auto& spectrum = signature.spectrum;
+
+      auto representative = Representative{ part, mesh_index };
+      representative.principal = spectrum[0] - spectrum[1] > AXIS_GAP * spectrum[0] &&
+                                 spectrum[1] - spectrum[2] > AXIS_GAP * spectrum[0];
+
+      const auto offset = [&](std::size_t i) {
+        return glm::dvec3{ vertices[i] } - signature.centroid;
+      };
+      const auto argmax = [&](auto&& score) {
+        auto best = std::size_t{ 0 };
+        for (auto i = std::size_t{ 1 }; i < vertices.size(); ++i) {
+          best = score(i) > score(best) ? i : best;
+        }
+        return best;
+      };
+
+      if (vertices.empty()) {
+        return representative;
+      }
+
+      if (representative.principal) {
+        // the vertex furthest along each axis fixes the sign of that axis
+        for (auto axis = 0; axis < 2; ++axis) {
+          representative.anchors[axis] = argmax(
+              [&](std::size_t i) { return std::abs(glm::dot(offset(i), signature.axes[axis])); });
+        }
+      } else {
+        // the vertex furthest from the centroid, then the one furthest from that line
+        const auto first = argmax([&](std::size_t i) { return glm::dot(offset(i), offset(i)); });
+        const auto direction = glm::dot(offset(first), offset(first)) > 0.0
+                                   ? glm::normalize(offset(first))
+                                   : glm::dvec3{ 1.0, 0.0, 0.0 };
+        representative.anchors[0] = first;
+        representative.anchors[1] = argmax([&](std::size_t i) {
+          const auto rejected = offset(i) - direction * glm::dot(offset(i), direction);
+          return glm::dot(rejected, rejected);
+        });
+      }
+      return representative;
+    }
+
+    // Orthonormal frame of a part with the axes as columns, always right handed so the transform
+    // between two frames is a rotation.
+    auto GetFrame(const Mesh& mesh, const Signature& signature, const Representative& reference)
+        -> glm::dmat3 {
+      const auto& vertices = mesh.getVertices();
+      if (vertices.empty()) {
+        return glm::dmat3{ 1.0 };
+      }
+
+      const auto offset = [&](std::size_t i) {
+        return glm::dvec3{ vertices[i] } - signature.centroid;
+      };
+
+      auto x = glm::dvec3{ 1.0, 0.0, 0.0 };
+      auto y = glm::dvec3{ 0.0, 1.0, 0.0 };
+      if (reference.principal) {
+        x = signature.axes[0];
+        y = signature.axes[1];
+        x = glm::dot(offset(reference.anchors[0]), x) < 0.0 ? -x : x;
+        y = glm::dot(offset(reference.anchors[1]), y) < 0.0 ? -y : y;
+      } else {
+        const auto first = offset(reference.anchors[0]);
+        x = glm::dot(first, first) > 0.0 ? glm::normalize(first) : x;
+
+        const auto second = offset(reference.anchors[1]);
+        const auto rejected = second - x * glm::dot(second, x);
+        const auto length = glm::length(rejected);
+        y = length > 1e-6 * glm::length(second) ? rejected / length : GetPerpendicular(x);
+      }
+
+      return glm::dmat3{ x, y, glm::cross(x, y) };
+    }
+
+    // Rigid transform mapping the representative onto the candidate, false when any vertex misses
+    // its counterpart by more than the tolerance.
+    auto Match(const Mesh& reference,
+               const Signature& reference_signature,
+               const Representative& representative,
+               const Mesh& candidate,
+               const Signature& candidate_signature,
+               float tolerance,
+               glm::mat4& transform) -> bool {
+      if (reference.getIndices() != candidate.getIndices() ||
+          reference.getVertices().size() != candidate.getVertices().size()) {
+        return false;
+      }
+
+      const auto size = std::sqrt(reference_signature.spectrum[0] +
+                                  reference_signature.spectrum[1] +
+                                  reference_signature.spectrum[2]);
+      const auto limit = static_cast<double>(tolerance) * std::max(size, 1e-12);
+
+      // the spread along each principal axis moves by at most the vertex error
+      for (auto axis = 0; axis < 3; ++axis) {
+        const auto delta = std::sqrt(reference_signature.spectrum[axis]) -
+                           std::sqrt(candidate_signature.spectrum[axis]);
+        if (std::abs(delta) > 2.0 * limit) {
+          return false;
+        }
+      }
+
+      const auto from_frame = GetFrame(reference, reference_signature, representative);
+      const auto to_frame = GetFrame(candidate, candidate_signature, representative);
+      const auto rotation = to_frame * glm::transpose(from_frame);
+      const auto& from = reference.getVertices();
+      const auto& to = candidate.getVertices();
+      for (auto i = std::size_t{ 0 }; i < from.size(); ++i) {
+        const auto mapped = rotation * (glm::dvec3{ from[i] } - reference_signature.centroid) +
+                            candidate_signature.centroid;
+        const auto error = mapped - glm::dvec3{ to[i] };
+        if (glm::dot(error, error) > limit * limit) {
+          return false;
+        }
+      }
+
+      const auto translation =
+          candidate_signature.centroid - rotation * reference_signature.centroid;
+      transform = glm::mat4{ glm::mat3{ rotation } };
+      transform[3] = glm::vec4{ glm::vec3{ translation }, 1.0f };
+      return true;
+    }
+
+  }  // namespace
+
+  auto InstanceMeshes(std::vector<std::unique_ptr<Mesh>> parts, float tolerance) -> Assembly {
+    for (auto& part : parts) {
+      if (!part) {
+        part = std::make_unique<Mesh>(std::vector<glm::vec3>{},
+                                      std::vector<glm::vec3>{},
+                                      std::vector<glm::uvec3>{});
+      }
+    }
+
+    auto signatures = std::vector<Signature>(parts.size());
+    ParallelFor(parts.size(), 1, [&](auto, auto begin, auto end) {
+      for (auto i = begin; i < end; ++i) {
+        signatures[i] = ComputeSignature(*parts[i]);
+      }
+    });
+
+    // Parts only ever match within a bucket of their topology and shape cell. Match bounds the
+    // spreads of a match to 2 tolerances of the size, which moves the shape by less than
+    // SHAPE_DRIFT tolerances, so a part near a cell boundary also looks across it.
+    const auto cell_size = std::max(SHAPE_CELL, 2.0 * SHAPE_DRIFT * static_cast<double>(tolerance));
+    const auto margin = SHAPE_DRIFT * static_cast<double>(tolerance) / cell_size;
+    auto assembly = Assembly{};
+    auto buckets = std::unordered_map<std::uint64_t, std::vector<Representative>>{};
+    auto unique = std::vector<bool>(parts.size(), false);
+    auto mesh_count = std::size_t{ 0 };
+    assembly.parts.resize(parts.size());
+
+    for (auto i = std::size_t{ 0 }; i < parts.size(); ++i) {
+      const auto position = signatures[i].shape / cell_size;
+      const auto cell = glm::ivec3{ glm::floor(position) };
+      const auto fraction = position - glm::floor(position);
+      auto side = glm::ivec3{ 0 };
+      for (auto axis = 0; axis < 3; ++axis) {
+        side[axis] = fraction[axis] < margin ? -1 : (fraction[axis] > 1.0 - margin ? 1 : 0);
+      }
+
+      auto& instance = assembly.parts[i];
+      auto found = false;
+      for (auto probe = 0; probe < 8 && !found; ++probe) {
+        const auto step = glm::ivec3{ probe & 1, (probe >> 1) & 1, (probe >> 2) & 1 };
+        if (glm::any(glm::greaterThan(step, glm::abs(side)))) {
+          continue;
+        }
+
+        const auto bucket = buckets.find(GetBucketKey(signatures[i].topology, cell + step * side));
+        if (bucket == buckets.end()) {
+          continue;
+        }
+
+        const auto match = std::find_if(
+            bucket->second.begin(), bucket->second.end(), [&](const auto& reference) {
+              return Match(*parts[reference.part],
+                           signatures[reference.part],
+                           reference,
+                           *parts[i],
+                           signatures[i],
+                           tolerance,
+                           instance.transform);
+            });
+
+        if (match != bucket->second.end()) {
+          instance.mesh = match->mesh;
+          found = true;
+        }
+      }
+
+      if (found) {
+        continue;
+      }
+
+      instance.mesh = mesh_count++;
+      buckets[GetBucketKey(signatures[i].topology, cell)].push_back(
+          MakeRepresentative(*parts[i], signatures[i], i, instance.mesh));
+      unique[i] = true;
+    }
+
+    // representatives read their part until the loop above is done, move them out afterwards
+    for (auto i = std::size_t{ 0 }; i < parts.size(); ++i) {
+      if (unique[i]) {
+        assembly.meshes.push_back(std::move(parts[i]));
+      }
+    }
+
+    return assembly;
+  }
+
+  auto LoadAssembly(std::span<const std::string_view> names, float tolerance) -> Assembly {
+    auto resources = std::vector<std::string>{};
+    resources.reserve(names.size());
+    for (const auto& name : names) {
+      resources.push_back(GetModelResourceName(name));
+    }
+
+    // every file is parsed as soon as its read completes, while the others are still in flight
+    auto parts = std::vector<std::unique_ptr<Mesh>>(names.size());
+    LoadResources(resources, [&parts](std::size_t index, std::span<const char> data) {
+      parts[index] = ParseMesh(data);
+    });
+
+    return InstanceMeshes(std::move(parts), tolerance);
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/mesh.hpp>
+
+namespace brabbit {
+
+  // One input part: its unique mesh and the rigid transform placing that mesh where the part was.
+  struct PartInstance {
+    std::size_t mesh{ 0 };
+    glm::mat4 transform{ 1.0f };
+  };
+
+  struct Assembly {
+    std::vector<std::unique_ptr<Mesh>> meshes{};  // unique geometry
+    std::vector<PartInstance> parts{};            // one per input part, in input order
+  };
+
+  // Collapse parts equal up to a rigid transform into a single mesh each. Parts match when they
+  // share the triangle list and every vertex lands within `tolerance` times the part size of its
+  // counterpart, which holds for copies exported in place and for baked copies, each quantized
+  // over its own bounds. The first part of a group keeps its geometry as is and gets the identity
+  // transform.
+  auto InstanceMeshes(std::vector<std::unique_ptr<Mesh>> parts, float tolerance = 1e-4f)
+      -> Assembly;
+
+  // Load model parts, baked or STL, through batched reads, parsing each as it arrives, then
+  // instance them. Files that fail to load give empty parts.
+  auto LoadAssembly(std::span<const std::string_view> names, float tolerance = 1e-4f) -> Assembly;
+
+}  // namespace brabbit
@@ -1,8 +1,11 @@
 #include <array>
 
 #include <brabbit/light.hpp>
+#include <brabbit/render_state.hpp>
 #include <brabbit/scene.hpp>
 #include <brabbit/flat_shader.hpp>
+#include <brabbit/shader_registry.hpp>
+#include <brabbit/vertex_layout.hpp>
 
 namespace brabbit {
 
@@ -23,7 +26,9 @@ namespace brabbit {
     };
     constexpr auto VERTICES_SIZE = VERTICES.size() * sizeof(GLfloat);
     constexpr auto VERTICES_DATA = VERTICES.data();
-    constexpr auto VERTICES_STRIDE = 3 * sizeof(GLfloat);
+
+    // positions only, the lamp is drawn in one flat color
+    using LampLayout = VertexLayout<VertexAttribute<0, glm::vec3>>;
 
     constexpr auto INDICES = std::array<GLuint, 36>{
       0, 1, 2,  1, 3, 2,  // front
@@ -44,45 +49,30 @@ namespace brabbit {
     updateModel();
     shader_ = LoadCachedShader<FlatShader>();
 
-    // Create and bind a VAO(Vertex Array Object)
-    glGenVertexArrays(1, &vao_);
-
-    // Load attributes in VAO
-    // From now on, any function call in this target will action on our VAO buffer.
-    glBindVertexArray(vao_);
+    // Create a VAO(Vertex Array Object) and describe our vertices data in it.
+    // The layout holds location, size, type, normalization, stride and offset of every attribute,
+    // derived at compile time, and enables them. (save in VAO)
+    glCreateVertexArrays(1, &vao_);
+    LampLayout::Apply(vao_);
 
-    // Generate a VBO(Vertex Buffer Object) buffer.
+    // Create a VBO(Vertex Buffer Object) buffer.
     // This buffer is use to send Vertex data to GPU from CPU.
-    glGenBuffers(1, &vbo_);
-
-    // Bind VBO buffer to GL_ARRAY_BUFFER(array buffer) target.
-    // From now on, any function call in this target will action on our VBO buffer.
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glCreateBuffers(1, &vbo_);
 
     // Copy real vertices data into VBO buffer.
     // param 4:
     // GL_STATIC_DRAW: The data will never or rarely change.
     // GL_DYNAMIC_DRAW：The data will be changed a lot.
     // GL_STREAM_DRAW：The data changes every time it is plotted.
-    glBufferData(GL_ARRAY_BUFFER, VERTICES_SIZE, VERTICES_DATA, GL_STATIC_DRAW);
+    glNamedBufferData(vbo_, VERTICES_SIZE, VERTICES_DATA, GL_STATIC_DRAW);
 
     // EBO/IBO (Element Buffer Object/Index Buffer Object)
-    glGenBuffers(1, &ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDICES_SIZE, INDICES_DATA, GL_STATIC_DRAW);
-
-    // Tell GPU how to decode our vertices data.
-    // Set attribute pointer's infomation about our vertices data. (save in VAO)
-    // param 1: [int] location index in vertex shader source: 'layout(location = 0)'
-    // param 2: [int] size of data, 3 means it's a 'vec3' attribute
-    // param 3: [enum] type of data, GL_FLOAT means float (of course..)
-    // param 4: [bool] need to normalize or not, GL_TRUE or GL_FALSE
-    // param 5: [int] stride, data's stride between each group
-    // param 6: [void*] offset, offset of data's begin position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTICES_STRIDE, reinterpret_cast<void*>(0));
-    // Make data attribute in location 0 enabled
-    // Call the 'glDisableVertexAttribArray' in some where to disabled it.
-    glEnableVertexAttribArray(0);
+    glCreateBuffers(1, &ebo_);
+    glNamedBufferData(ebo_, INDICES_SIZE, INDICES_DATA, GL_STATIC_DRAW);
+
+    // Attach both buffers to the VAO, the vertices to binding point 0 the layout reads.
+    LampLayout::BindBuffer(vao_, 0, vbo_);
+    glVertexArrayElementBuffer(vao_, ebo_);
   }
 
   Light::~Light() {
@@ -136,23 +126,16 @@ namespace brabbit {
     }
 
     auto* shader = static_cast<FlatShader*>(shader_);
-    if (!shader) {
-      return;
-    }
-
-    auto* camera = scene_->getCamera();
-    if (!camera) {
+    if (!shader || !shader->isReady()) {
       return;
     }
 
     shader->use();
     shader->setModel(getScaledModel());
-    shader->setView(camera->getView());
-    shader->setProjection(camera->getProjection());
     shader->setLightColor(color_);
 
     // Load attributes in VAO
-    glBindVertexArray(vao_);
+    GetRenderState().bindVertexArray(vao_);
 
     // Use EBO and VB0 to draw the triangle
     // param 1: [enum] type to draw
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <brabbit/lz.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto MIN_MATCH = std::size_t{ 4 };
+    constexpr auto MAX_OFFSET = std::size_t{ 65535 };
+    constexpr auto HASH_BITS = 16;
+
+    auto Load32(const char* data) -> std::uint32_t {
+      auto value = std::uint32_t{ 0 };
+      std::memcpy(&value, data, sizeof(value));
+      return value;
+    }
+
+    auto Hash(std::uint32_t value) -> std::uint32_t {
+      return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Length above the 15 a token nibble holds, as a run of 255 bytes and a remainder.
+    auto WriteLength(std::vector<char>& output, std::size_t length) -> void {
+      for (; length >= 255; length -= 255) {
+        output.push_back(static_cast<char>(255));
+      }
+      output.push_back(static_cast<char>(length));
+    }
+
+    auto ReadLength(std::span<const char> input, std::size_t& position, std::size_t& length)
+        -> bool {
+      while (position < input.size()) {
+        const auto byte = static_cast<std::uint8_t>(input[position++]);
+        length += byte;
+        if (byte != 255) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    auto WriteSequence(std::vector<char>& output,
+                       std::span<const char> literals,
+                       std::size_t match_length,
+                       std::size_t offset) -> void {
+      const auto literal_nibble = std::min<std::size_t>(literals.size(), 15);
+      const auto match_nibble =
+          match_length == 0 ? 0 : std::min<std::size_t>(match_length - MIN_MATCH, 15);
+      output.push_back(static_cast<char>(literal_nibble << 4 | match_nibble));
+      if (literal_nibble == 15) {
+        WriteLength(output, literals.size() - 15);
+      }
+      output.insert(output.end(), literals.begin(), literals.end());
+
+      if (match_length == 0) {
+        return;
+      }
+      output.push_back(static_cast<char>(offset & 0xFF));
+      output.push_back(static_cast<char>(offset >> 8));
+      if (match_nibble == 15) {
+        WriteLength(output, match_length - MIN_MATCH - 15);
+      }
+    }
+
+  }  // namespace
+
+  auto CompressLz(std::span<const char> input) -> std::vector<char> {
+    auto output = std::vector<char>{};
+    output.reserve(input.size() / 2 + 16);
+
+    // greedy parse, the table keeps the last position of every hashed 4 byte sequence
+    auto table = std::vector<std::uint32_t>(std::size_t{ 1 } << HASH_BITS, 0);
+    auto anchor = std::size_t{ 0 };
+    auto position = std::size_t{ 0 };
+    while (position + MIN_MATCH <= input.size()) {
+      const auto value = Load32(input.data() + position);
+      auto& slot = table[Hash(value)];
+      const auto candidate = static_cast<std::size_t>(slot);
+      slot = static_cast<std::uint32_t>(position);
+
+      const auto offset = position - candidate;
+      if (candidate >= position || offset > MAX_OFFSET ||
+          Load32(input.data() + candidate) != value) {
+        ++position;
+        continue;
+      }
+
+      auto length = MIN_MATCH;
+      while (position + length < input.size() &&
+             input[candidate + length] == input[position + length]) {
+        ++length;
+      }
+
+      WriteSequence(output, input.subspan(anchor, position - anchor), length, offset);
+      position += length;
+      anchor = position;
+    }
+
+    WriteSequence(output, input.subspan(anchor), 0, 0);
+    return output;
+  }
+
+  auto DecompressLz(std::span<const char> input, std::span<char> output) -> bool {
+    auto read = std::size_t{ 0 };
+    auto written = std::size_t{ 0 };
+    while (read < input.size()) {
+      const auto token = static_cast<std::uint8_t>(input[read++]);
+
+      auto literals = static_cast<std::size_t>(token >> 4);
+      if (literals == 15 && !ReadLength(input, read, literals)) {
+        return false;
+      }
+      if (literals > input.size() - read || literals > output.size() - written) {
+        return false;
+      }
+      std::memcpy(output.data() + written, input.data() + read, literals);
+      read += literals;
+      written += literals;
+
+      // the last sequence ends with its literals
+      if (read == input.size()) {
+        break;
+      }
+
+      if (input.size() - read < 2) {
+        return false;
+      }
+      const auto low = static_cast<std::uint8_t>(input[read]);
+      const auto high = static_cast<std::uint8_t>(input[read + 1]);
+      const auto offset = static_cast<std::size_t>(low | high << 8);
+      read += 2;
+
+      auto length = static_cast<std::size_t>(token & 0x0F);
+      if (length == 15 && !ReadLength(input, read, length)) {
+        return false;
+      }
+      length += MIN_MATCH;
+      if (offset == 0 || offset > written || length > output.size() - written) {
+        return false;
+      }
+
+      // matches may overlap their own output, copy forward byte by byte then
+      auto* target = output.data() + written;
+      const auto* source = target - offset;
+      if (offset >= length) {
+        std::memcpy(target, source, length);
+      } else {
+        for (auto i = std::size_t{ 0 }; i < length; ++i) {
+          target[i] = source[i];
+        }
+      }
+      written += length;
+    }
+
+    return written == output.size();
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+namespace brabbit {
+
+  // Byte oriented LZ77 in the style of LZ4, no entropy stage so decoding runs near memcpy speed.
+  // A block is a list of sequences: a token with 4 bit literal and match lengths, extended by
+  // 255 bytes when saturated, the literals, then a 16 bit little endian match offset. The last
+  // sequence carries literals only.
+  auto CompressLz(std::span<const char> input) -> std::vector<char>;
+
+  // Decode a block into output, which must be exactly the original size. False when the block is
+  // malformed or does not fill the output.
+  auto DecompressLz(std::span<const char> input, std::span<char> output) -> bool;
+
+}  // namespace brabbit
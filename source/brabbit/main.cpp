@@ -31,10 +31,13 @@ auto main(int argc, char** argv) -> int {
   light->setLampVisible(true);
 
   auto  mesh  = std::make_unique<brabbit::Mesh>("cube.stl"sv);
+  mesh->bakeAmbientOcclusion();
+
   auto* model = scene->emplaceObject<brabbit::Model>(mesh);
   if (!model) {
     return -1;
   }
+  model->setAnimated(true);
 
   return window->executeLoop();
 }
@@ -1,6 +1,6 @@
-#include <array>
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
+#include <utility>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,134 +10,47 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <brabbit/mesh.hpp>
+#include <brabbit/mesh_format.hpp>
+#include <brabbit/occlusion.hpp>
+#include <brabbit/parallel.hpp>
+#include <brabbit/resource_pack.hpp>
 
 namespace brabbit {
 
   using namespace std::string_literals;
   using namespace std::string_view_literals;
 
-  namespace {
-
-    struct Stl {
-      struct Facet {
-        glm::vec3 normal{};
-        std::array<glm::vec3, 3> vertices{};
-      };
-
-      std::string name{};
-      std::vector<Facet> facets{};
-    };
-
-    auto Trim(std::string& string) -> void {
-      constexpr auto notspace = [](unsigned char ch) { return !std::isspace(ch); };
-      string.erase(string.begin(), std::find_if(string.begin(), string.end(), notspace));
-      string.erase(std::find_if(string.rbegin(), string.rend(), notspace).base(), string.end());
-    }
-
-    auto LoadStlFile(std::string_view name) -> Stl {
-      auto path = std::filesystem::current_path() / "resource"sv / "model"sv / name;
-      if (!std::filesystem::exists(path)) {
-        return {};
-      }
-
-      auto file = std::ifstream{ path, std::ios::binary };
-      if (!file) {
-        return {};
-      }
-
-      auto stl = Stl{};
-      auto line = std::string{};
-      auto index = -1;
-      while (std::getline(file, line)) {
-        Trim(line);
-
-        if (line.empty()) {
-          continue;
-        }
-
-        constexpr auto BEGIN_SOLID = "solid "sv;
-        constexpr auto BEGIN_FACET = "facet normal "sv;
-        constexpr auto BEGIN_LOOP  = "outer loop"sv;
-        constexpr auto VERTEX      = "vertex "sv;
-        constexpr auto END_LOOP    = "endloop"sv;
-        constexpr auto END_FACET   = "endfacet"sv;
-        constexpr auto END_SOLID   = "endsolid"sv;
-
-        if (line.starts_with(BEGIN_SOLID)) {
-          stl.name = line.substr(BEGIN_SOLID.size());
-          continue;
-        }
-
-        if (line.starts_with(BEGIN_FACET)) {
-          auto& facet = stl.facets.emplace_back();
-          auto stream = std::istringstream{ line.substr(BEGIN_FACET.size()) };
-          stream >> facet.normal.x >> facet.normal.y >> facet.normal.z;
-          if (stream.fail()) {
-            stl.facets.pop_back();
-          }
-
-          continue;
-        }
-
-        if (line.starts_with(BEGIN_LOOP)) {
-          index = 0;
-          continue;
-        }
-
-        if (line.starts_with(VERTEX)) {
-          if (0 > index || index > 2) {
-            continue;
-          }
-
-          auto& facet = stl.facets.back();
-          auto& vertex = facet.vertices.at(index);
-          auto stream = std::istringstream{ line.substr(VERTEX.size()) };
-          stream >> vertex.x >> vertex.y >> vertex.z;
-
-          if (stream.fail()) {
-            stl.facets.pop_back();
-          }
-
-          ++index;
-          continue;
-        }
-
-        if (line.starts_with(END_LOOP)) {
-          if (index != 3) {
-            stl.facets.pop_back();
-          }
-
-          index = -1;
-          continue;
-        }
-
-        if (line.starts_with(END_FACET)) {
-          continue;
-        }
+  Mesh::Mesh(std::string_view model_name) {
+    const auto resource = LoadResource(GetModelResourceName(model_name));
+    auto data = ParseMeshData(resource.getData());
+    vertices_ = std::move(data.vertices);
+    normals_ = std::move(data.normals);
+    indices_ = std::move(data.indices);
+  }
 
-        if (line.starts_with(END_SOLID)) {
-          continue;
-        }
+  Mesh::Mesh(std::vector<glm::vec3> vertices,
+             std::vector<glm::vec3> normals,
+             std::vector<glm::uvec3> indices)
+      : vertices_{ std::move(vertices) },
+        normals_{ std::move(normals) },
+        indices_{ std::move(indices) } {}
+
+  auto GetModelResourceName(std::string_view model_name) -> std::string {
+    // baked models only exist in packs built by the resource target
+    if (const auto* pack = GetResourcePack(); pack) {
+      auto baked = std::filesystem::path{ "model"sv } / model_name;
+      baked.replace_extension(".mesh"sv);
+      if (auto name = baked.generic_string(); pack->find(name)) {
+        return name;
       }
-
-      return stl;
-    }
-
-  }  // namespace
-
-  Mesh::Mesh(std::string_view model_name) {
-    auto stl = LoadStlFile(model_name);
-    if (stl.facets.empty()) {
-      return;
     }
+    return "model/"s.append(model_name);
+  }
 
-    for (auto& facet : stl.facets) {
-      indices_.emplace_back(vertices_.size(), vertices_.size() + 1, vertices_.size() + 2);
-      vertices_.insert(vertices_.end(),
-                       std::make_move_iterator(facet.vertices.begin()),
-                       std::make_move_iterator(facet.vertices.end()));
-      normals_.insert(normals_.end(), 3, facet.normal);
-    }
+  auto ParseMesh(std::span<const char> data) -> std::unique_ptr<Mesh> {
+    auto mesh = ParseMeshData(data);
+    return std::make_unique<Mesh>(
+        std::move(mesh.vertices), std::move(mesh.normals), std::move(mesh.indices));
   }
 
   auto Mesh::getVertices() const -> const std::vector<glm::vec3>& {
@@ -176,4 +89,146 @@ namespace brabbit {
     return indices_.size() * sizeof(glm::uvec3);
   }
 
+  auto Mesh::getAmbientOcclusion() const -> const std::vector<float>& {
+    return ambient_occlusion_;
+  }
+
+  auto Mesh::getAmbientOcclusionData() const -> const float* {
+    return ambient_occlusion_.data();
+  }
+
+  auto Mesh::getAmbientOcclusionSize() const -> std::size_t {
+    return ambient_occlusion_.size() * sizeof(float);
+  }
+
+  auto Mesh::bakeAmbientOcclusion(int samples) -> void {
+    ambient_occlusion_ = BakeAmbientOcclusion(*this, samples);
+  }
+
+  auto Mesh::isDynamic() const -> bool {
+    return dynamic_;
+  }
+
+  auto Mesh::setDynamic(bool dynamic) -> void {
+    dynamic_ = dynamic;
+  }
+
+  auto Mesh::editVertices(std::size_t first, std::size_t count) -> std::span<glm::vec3> {
+    first = std::min(first, vertices_.size());
+    count = std::min(count, vertices_.size() - first);
+    changes_.vertices.add(first, count);
+    invalidate();
+    return std::span{ vertices_ }.subspan(first, count);
+  }
+
+  auto Mesh::editNormals(std::size_t first, std::size_t count) -> std::span<glm::vec3> {
+    first = std::min(first, normals_.size());
+    count = std::min(count, normals_.size() - first);
+    changes_.normals.add(first, count);
+    return std::span{ normals_ }.subspan(first, count);
+  }
+
+  auto Mesh::editIndices(std::size_t first, std::size_t count) -> std::span<glm::uvec3> {
+    first = std::min(first, indices_.size());
+    count = std::min(count, indices_.size() - first);
+    changes_.indices.add(first, count);
+    invalidate();
+    return std::span{ indices_ }.subspan(first, count);
+  }
+
+  auto Mesh::resize(std::size_t vertex_count, std::size_t triangle_count) -> void {
+    if (vertex_count > vertices_.size()) {
+      changes_.vertices.add(vertices_.size(), vertex_count - vertices_.size());
+    }
+    if (vertex_count > normals_.size()) {
+      changes_.normals.add(normals_.size(), vertex_count - normals_.size());
+    }
+    if (triangle_count > indices_.size()) {
+      changes_.indices.add(indices_.size(), triangle_count - indices_.size());
+    }
+
+    vertices_.resize(vertex_count, glm::vec3{ 0.0f });
+    normals_.resize(vertex_count, glm::vec3{ 0.0f });
+    indices_.resize(triangle_count, glm::uvec3{ 0 });
+    changes_.vertices.clamp(vertex_count);
+    changes_.normals.clamp(vertex_count);
+    changes_.indices.clamp(triangle_count);
+    invalidate();
+  }
+
+  auto Mesh::takeChanges() -> MeshChanges {
+    return std::exchange(changes_, MeshChanges{});
+  }
+
+  auto Mesh::invalidate() -> void {
+    bvh_valid_.store(false, std::memory_order_release);
+  }
+
+  auto Mesh::getBounds() const -> Aabb {
+    return getBvh().getBounds();
+  }
+
+  auto Mesh::getBvh() const -> const Bvh& {
+    if (bvh_valid_.load(std::memory_order_acquire)) {
+      return *bvh_;
+    }
+
+    auto lock = std::scoped_lock{ bvh_mutex_ };
+    if (!bvh_valid_.load(std::memory_order_relaxed)) {
+      auto bounds = std::vector<Aabb>(indices_.size());
+      ParallelFor(indices_.size(), 4096, [this, &bounds](auto, auto begin, auto end) {
+        for (auto i = begin; i < end; ++i) {
+          const auto& triangle = indices_[i];
+          auto& box = bounds[i];
+          box.expand(vertices_[triangle.x]);
+          box.expand(vertices_[triangle.y]);
+          box.expand(vertices_[triangle.z]);
+        }
+      });
+
+      if (bvh_ && bvh_->getPrimitives().size() == bounds.size()) {
+        bvh_->refit(bounds);
+      } else {
+        bvh_ = std::make_unique<Bvh>(bounds);
+      }
+      bvh_valid_.store(true, std::memory_order_release);
+    }
+
+    return *bvh_;
+  }
+
+  auto Mesh::intersect(const Ray& ray, RayHit& hit) const -> bool {
+    auto found = false;
+    getBvh().traverse(ray, hit.distance, [this, &ray, &hit, &found](auto primitive, auto& max) {
+      const auto& triangle = indices_[primitive];
+      const auto& a = vertices_[triangle.x];
+      const auto& b = vertices_[triangle.y];
+      const auto& c = vertices_[triangle.z];
+      if (IntersectTriangle(ray, a, b, c, hit)) {
+        hit.primitive = primitive;
+        max = hit.distance;
+        found = true;
+      }
+    });
+
+    return found;
+  }
+
+  auto Mesh::closestPoint(const glm::vec3& point, float max_distance) const -> ClosestPoint {
+    auto result = ClosestPoint{};
+    getBvh().traverseNearest(point, max_distance, [this, &point, &result](auto primitive, auto& max) {
+      const auto& triangle = indices_[primitive];
+      const auto position = ClosestPointOnTriangle(
+          point, vertices_[triangle.x], vertices_[triangle.y], vertices_[triangle.z]);
+      const auto delta = position - point;
+      const auto distance_squared = glm::dot(delta, delta);
+      if (distance_squared < max) {
+        max = distance_squared;
+        result = { std::sqrt(distance_squared), primitive, position };
+      }
+    });
+
+    return result;
+  }
+
 }  // namespace brabbit
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -7,13 +12,26 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <brabbit/bvh.hpp>
+#include <brabbit/dirty_ranges.hpp>
+#include <brabbit/parallel.hpp>
 #include <brabbit/scene.hpp>
 
 namespace brabbit {
 
+  // Element ranges of a mesh edited since they were last taken.
+  struct MeshChanges {
+    DirtyRanges vertices{};
+    DirtyRanges normals{};
+    DirtyRanges indices{};  // in triangles
+  };
+
   class Mesh {
    public:
     explicit Mesh(std::string_view model_name);
+    explicit Mesh(std::vector<glm::vec3> vertices,
+                  std::vector<glm::vec3> normals,
+                  std::vector<glm::uvec3> indices);
     virtual ~Mesh() = default;
 
    public:
@@ -29,10 +47,101 @@ namespace brabbit {
     auto getIndicesData() const -> const glm::uint*;
     auto getIndicesSize() const -> std::size_t;
 
+    // Baked ambient occlusion per vertex, empty until bakeAmbientOcclusion is called.
+    auto getAmbientOcclusion() const -> const std::vector<float>&;
+    auto getAmbientOcclusionData() const -> const float*;
+    auto getAmbientOcclusionSize() const -> std::size_t;
+
+   public:
+    // Bake before creating Models of this mesh, they upload it once on creation.
+    // Dynamic meshes are drawn without it.
+    auto bakeAmbientOcclusion(int samples = 64) -> void;
+
+   public:
+    // Dynamic meshes are drawn from buffers updated in place with the edited ranges only.
+    // Set before creating the Model, a dynamic mesh is meant to be drawn by a single Model.
+    auto isDynamic() const -> bool;
+    auto setDynamic(bool dynamic) -> void;
+
+    // Writable views, the range is recorded for the next upload. Views stay valid until resize(),
+    // references to the BVH until the next edit.
+    auto editVertices(std::size_t first, std::size_t count) -> std::span<glm::vec3>;
+    auto editNormals(std::size_t first, std::size_t count) -> std::span<glm::vec3>;
+    auto editIndices(std::size_t first, std::size_t count) -> std::span<glm::uvec3>;
+
+    // Grow or shrink the arrays, new elements are zero and recorded as edited.
+    auto resize(std::size_t vertex_count, std::size_t triangle_count) -> void;
+
+    // Bulk edit of positions and normals on worker threads. Chunks start at multiples of
+    // DEFORM_ALIGNMENT vertices, so their float data can be processed with SIMD loops.
+    // function: (std::size_t first, std::span<glm::vec3> vertices, std::span<glm::vec3> normals)
+    template <typename _Function>
+    auto deform(_Function&& function) -> void;
+
+    // Changes since the last call, taken by the Model drawing this mesh.
+    auto takeChanges() -> MeshChanges;
+
+    static constexpr auto DEFORM_ALIGNMENT = std::size_t{ 8 };
+
+   public:
+    auto getBounds() const -> Aabb;
+
+    // Triangle BVH, built on first use.
+    auto getBvh() const -> const Bvh&;
+
+    // Closest triangle hit by the ray, hit.primitive is the triangle index.
+    auto intersect(const Ray& ray, RayHit& hit) const -> bool;
+
+    // Closest surface point within max_distance, primitive is INVALID_INDEX when there is none.
+    auto closestPoint(const glm::vec3& point,
+                      float max_distance = std::numeric_limits<float>::infinity()) const
+        -> ClosestPoint;
+
    protected:
     std::vector<glm::vec3> vertices_{};
     std::vector<glm::vec3> normals_{};
     std::vector<glm::uvec3> indices_{};
+    std::vector<float> ambient_occlusion_{};
+
+   private:
+    auto invalidate() -> void;
+
+   private:
+    bool dynamic_{ false };
+    MeshChanges changes_{};
+
+    // edits clear bvh_valid_, the next query refits the tree or rebuilds it when the count changed
+    mutable std::mutex bvh_mutex_{};
+    mutable std::atomic<bool> bvh_valid_{ false };
+    mutable std::unique_ptr<Bvh> bvh_{ nullptr };
   };
 
+  // Resource name of a model, its baked version when the resource pack holds one.
+  auto GetModelResourceName(std::string_view model_name) -> std::string;
+
+  // Mesh of a baked model or an ASCII STL file already in memory, empty when nothing parses.
+  auto ParseMesh(std::span<const char> data) -> std::unique_ptr<Mesh>;
+
+  template <typename _Function>
+  auto Mesh::deform(_Function&& function) -> void {
+    // split into whole blocks of DEFORM_ALIGNMENT vertices, one call per worker
+    const auto count = vertices_.size();
+    const auto blocks = (count + DEFORM_ALIGNMENT - 1) / DEFORM_ALIGNMENT;
+    const auto has_normals = normals_.size() == count;
+
+    ParallelFor(blocks, 512, [&](auto, auto begin, auto end) {
+      const auto first = begin * DEFORM_ALIGNMENT;
+      const auto size = std::min(count, end * DEFORM_ALIGNMENT) - first;
+      function(first,
+               std::span{ vertices_ }.subspan(first, size),
+               has_normals ? std::span{ normals_ }.subspan(first, size) : std::span<glm::vec3>{});
+    });
+
+    changes_.vertices.add(0, count);
+    if (has_normals) {
+      changes_.normals.add(0, count);
+    }
+    invalidate();
+  }
+
 }  // namespace brabbit
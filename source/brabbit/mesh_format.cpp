@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <brabbit/mesh_format.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  namespace {
+
+    struct Stl {
+      struct Facet {
+        glm::vec3 normal{};
+        std::array<glm::vec3, 3> vertices{};
+      };
+
+      std::string name{};
+      std::vector<Facet> facets{};
+    };
+
+    auto Trim(std::string_view string) -> std::string_view {
+      constexpr auto notspace = [](unsigned char ch) { return !std::isspace(ch); };
+      const auto begin = std::find_if(string.begin(), string.end(), notspace);
+      const auto end = std::find_if(string.rbegin(), string.rend(), notspace).base();
+      return begin < end ? std::string_view{ begin, end } : std::string_view{};
+    }
+
+    // Three whitespace separated floats, false when any is missing or malformed.
+    auto ParseVector(std::string_view text, glm::vec3& vector) -> bool {
+      for (auto i = 0; i < 3; ++i) {
+        text = Trim(text);
+        if (text.starts_with('+')) {
+          text.remove_prefix(1);
+        }
+
+        const auto* last = text.data() + text.size();
+        const auto [end, error] = std::from_chars(text.data(), last, vector[i]);
+        if (error != std::errc{}) {
+          return false;
+        }
+        text.remove_prefix(end - text.data());
+      }
+      return true;
+    }
+
+    // ASCII STL straight from the file contents, no stream or line copies.
+    auto ParseFacets(std::span<const char> data) -> Stl {
+      auto stl = Stl{};
+      auto text = std::string_view{ data.data(), data.size() };
+      auto index = -1;
+      while (!text.empty()) {
+        const auto end = text.find('\n');
+        const auto line = Trim(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+        if (line.empty()) {
+          continue;
+        }
+
+        constexpr auto BEGIN_SOLID = "solid "sv;
+        constexpr auto BEGIN_FACET = "facet normal "sv;
+        constexpr auto BEGIN_LOOP  = "outer loop"sv;
+        constexpr auto VERTEX      = "vertex "sv;
+        constexpr auto END_LOOP    = "endloop"sv;
+        constexpr auto END_FACET   = "endfacet"sv;
+        constexpr auto END_SOLID   = "endsolid"sv;
+
+        if (line.starts_with(BEGIN_SOLID)) {
+          stl.name = line.substr(BEGIN_SOLID.size());
+          continue;
+        }
+
+        if (line.starts_with(BEGIN_FACET)) {
+          auto& facet = stl.facets.emplace_back();
+          if (!ParseVector(line.substr(BEGIN_FACET.size()), facet.normal)) {
+            stl.facets.pop_back();
+          }
+
+          continue;
+        }
+
+        if (line.starts_with(BEGIN_LOOP)) {
+          index = 0;
+          continue;
+        }
+
+        if (line.starts_with(VERTEX)) {
+          if (0 > index || index > 2 || stl.facets.empty()) {
+            continue;
+          }
+
+          auto& facet = stl.facets.back();
+          auto& vertex = facet.vertices.at(index);
+          if (!ParseVector(line.substr(VERTEX.size()), vertex)) {
+            stl.facets.pop_back();
+          }
+
+          ++index;
+          continue;
+        }
+
+        if (line.starts_with(END_LOOP)) {
+          if (index != 3 && !stl.facets.empty()) {
+            stl.facets.pop_back();
+          }
+
+          index = -1;
+          continue;
+        }
+
+        if (line.starts_with(END_FACET)) {
+          continue;
+        }
+
+        if (line.starts_with(END_SOLID)) {
+          continue;
+        }
+      }
+
+      return stl;
+    }
+
+    constexpr auto QUANTIZED_MAX = 65535.0f;
+    constexpr auto SNORM_MAX = 32767.0f;
+
+    // outside the snorm range, marks a vertex the source file left without a normal
+    constexpr auto NO_NORMAL = glm::i16vec2{ -32768, -32768 };
+
+    // Octahedral mapping of a unit vector onto [-1, 1]^2 (Cigolle et al. 2014).
+    auto EncodeNormal(const glm::vec3& normal) -> glm::i16vec2 {
+      const auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+      if (!(length > 0.0f)) {
+        return NO_NORMAL;
+      }
+
+      auto octahedral = glm::vec2{ normal } / length;
+      if (normal.z < 0.0f) {
+        const auto sign = glm::vec2{ octahedral.x >= 0.0f ? 1.0f : -1.0f,
+                                     octahedral.y >= 0.0f ? 1.0f : -1.0f };
+        octahedral = (1.0f - glm::abs(glm::vec2{ octahedral.y, octahedral.x })) * sign;
+      }
+      return glm::i16vec2{ glm::round(glm::clamp(octahedral, -1.0f, 1.0f) * SNORM_MAX) };
+    }
+
+    auto DecodeNormal(const glm::i16vec2& encoded) -> glm::vec3 {
+      if (encoded == NO_NORMAL) {
+        return glm::vec3{ 0.0f };
+      }
+
+      const auto octahedral = glm::vec2{ encoded } / SNORM_MAX;
+      auto normal = glm::vec3{ octahedral, 1.0f - std::abs(octahedral.x) - std::abs(octahedral.y) };
+      const auto fold = std::max(-normal.z, 0.0f);
+      normal.x += normal.x >= 0.0f ? -fold : fold;
+      normal.y += normal.y >= 0.0f ? -fold : fold;
+      return glm::normalize(normal);
+    }
+
+    // Only bit equal vertices are welded, the duplicates STL writes for every facet. Nearby ones
+    // stay apart, so the triangle list of a part does not depend on where it was exported.
+    struct WeldKey {
+      std::array<std::uint32_t, 6> bits{};
+
+      explicit WeldKey(const glm::vec3& position, const glm::vec3& normal) {
+        const auto values = std::array<float, 6>{
+          position.x, position.y, position.z, normal.x, normal.y, normal.z
+        };
+        std::memcpy(bits.data(), values.data(), sizeof(bits));
+      }
+
+      auto operator==(const WeldKey& other) const -> bool = default;
+    };
+
+    struct WeldKeyHash {
+      auto operator()(const WeldKey& key) const -> std::size_t {
+        auto hash = std::uint64_t{ 0xCBF29CE484222325 };
+        for (const auto word : key.bits) {
+          hash = (hash ^ word) * 0x100000001B3;
+        }
+        return static_cast<std::size_t>(hash ^ hash >> 32);
+      }
+    };
+
+    template <typename _Type>
+    auto Append(std::vector<char>& output, const _Type& value) -> void {
+      const auto* bytes = reinterpret_cast<const char*>(&value);
+      output.insert(output.end(), bytes, bytes + sizeof(value));
+    }
+
+    template <typename _Type>
+    auto Read(std::span<const char> data, std::size_t offset) -> _Type {
+      auto value = _Type{};
+      std::memcpy(&value, data.data() + offset, sizeof(value));
+      return value;
+    }
+
+  }  // namespace
+
+  auto ParseStl(std::span<const char> data) -> MeshData {
+    const auto stl = ParseFacets(data);
+
+    auto mesh = MeshData{};
+    mesh.vertices.reserve(stl.facets.size() * 3);
+    mesh.normals.reserve(stl.facets.size() * 3);
+    mesh.indices.reserve(stl.facets.size());
+    for (const auto& facet : stl.facets) {
+      const auto first = static_cast<glm::uint>(mesh.vertices.size());
+      mesh.indices.emplace_back(first, first + 1, first + 2);
+      mesh.vertices.insert(mesh.vertices.end(), facet.vertices.begin(), facet.vertices.end());
+      mesh.normals.insert(mesh.normals.end(), 3, facet.normal);
+    }
+    return mesh;
+  }
+
+  auto BakeMesh(const MeshData& mesh) -> std::vector<char> {
+    if (mesh.vertices.empty() || mesh.normals.size() != mesh.vertices.size()) {
+      return {};
+    }
+
+    auto header = BakedMeshHeader{};
+    auto min = glm::vec3{ std::numeric_limits<float>::infinity() };
+    auto max = glm::vec3{ -std::numeric_limits<float>::infinity() };
+    for (const auto& vertex : mesh.vertices) {
+      min = glm::min(min, vertex);
+      max = glm::max(max, vertex);
+    }
+    const auto extent = max - min;
+    const auto scale = glm::vec3{ extent.x > 0.0f ? QUANTIZED_MAX / extent.x : 0.0f,
+                                  extent.y > 0.0f ? QUANTIZED_MAX / extent.y : 0.0f,
+                                  extent.z > 0.0f ? QUANTIZED_MAX / extent.z : 0.0f };
+
+    // vertices keep the order they are first used in, which keeps the index stream local
+    auto welded = std::unordered_map<WeldKey, glm::uint, WeldKeyHash>{};
+    auto unique = std::vector<std::size_t>{};
+    auto remap = std::vector<glm::uint>(mesh.vertices.size());
+    for (auto i = std::size_t{ 0 }; i < mesh.vertices.size(); ++i) {
+      const auto key = WeldKey{ mesh.vertices[i], mesh.normals[i] };
+      const auto [iter, inserted] = welded.try_emplace(key, static_cast<glm::uint>(unique.size()));
+      if (inserted) {
+        unique.push_back(i);
+      }
+      remap[i] = iter->second;
+    }
+
+    header.vertex_count = static_cast<std::uint32_t>(unique.size());
+    header.triangle_count = static_cast<std::uint32_t>(mesh.indices.size());
+    for (auto axis = 0; axis < 3; ++axis) {
+      header.min[axis] = min[axis];
+      header.max[axis] = max[axis];
+    }
+
+    auto output = std::vector<char>{};
+    output.reserve(sizeof(header) + unique.size() * 10 + mesh.indices.size() * 12);
+    Append(output, header);
+    for (const auto index : unique) {
+      Append(output, glm::u16vec3{ glm::round((mesh.vertices[index] - min) * scale) });
+    }
+    for (const auto index : unique) {
+      const auto& normal = mesh.normals[index];
+      const auto length = glm::length(normal);
+      Append(output, EncodeNormal(length > 0.0f ? normal / length : glm::vec3{ 0.0f }));
+    }
+    for (const auto& triangle : mesh.indices) {
+      Append(output, glm::uvec3{ remap[triangle.x], remap[triangle.y], remap[triangle.z] });
+    }
+    return output;
+  }
+
+  auto ParseBakedMesh(std::span<const char> data) -> MeshData {
+    if (data.size() < sizeof(BakedMeshHeader)) {
+      return {};
+    }
+
+    const auto header = Read<BakedMeshHeader>(data, 0);
+    const auto vertex_count = std::size_t{ header.vertex_count };
+    const auto triangle_count = std::size_t{ header.triangle_count };
+    const auto positions = sizeof(BakedMeshHeader);
+    const auto normals = positions + vertex_count * sizeof(glm::u16vec3);
+    const auto indices = normals + vertex_count * sizeof(glm::i16vec2);
+    const auto end = indices + triangle_count * sizeof(glm::uvec3);
+    if (header.magic != BAKED_MESH_MAGIC || header.version != BAKED_MESH_VERSION ||
+        end != data.size()) {
+      return {};
+    }
+
+    const auto min = glm::vec3{ header.min[0], header.min[1], header.min[2] };
+    const auto step = (glm::vec3{ header.max[0], header.max[1], header.max[2] } - min) /
+                      QUANTIZED_MAX;
+
+    auto mesh = MeshData{};
+    mesh.vertices.resize(vertex_count);
+    mesh.normals.resize(vertex_count);
+    mesh.indices.resize(triangle_count);
+    for (auto i = std::size_t{ 0 }; i < vertex_count; ++i) {
+      const auto position = Read<glm::u16vec3>(data, positions + i * sizeof(glm::u16vec3));
+      mesh.vertices[i] = min + glm::vec3{ position } * step;
+      mesh.normals[i] = DecodeNormal(Read<glm::i16vec2>(data, normals + i * sizeof(glm::i16vec2)));
+    }
+
+    std::memcpy(mesh.indices.data(), data.data() + indices, triangle_count * sizeof(glm::uvec3));
+    for (const auto& triangle : mesh.indices) {
+      if (triangle.x >= vertex_count || triangle.y >= vertex_count || triangle.z >= vertex_count) {
+        return {};
+      }
+    }
+    return mesh;
+  }
+
+  auto ParseMeshData(std::span<const char> data) -> MeshData {
+    const auto baked = data.size() >= sizeof(std::uint32_t) &&
+                       Read<std::uint32_t>(data, 0) == BAKED_MESH_MAGIC;
+    return baked ? ParseBakedMesh(data) : ParseStl(data);
+  }
+
+}  // namespace brabbit
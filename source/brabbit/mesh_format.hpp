@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  // Geometry as read from a file, before it becomes a Mesh.
+  struct MeshData {
+    std::vector<glm::vec3> vertices{};
+    std::vector<glm::vec3> normals{};
+    std::vector<glm::uvec3> indices{};
+  };
+
+  // Baked model layout, little endian, written by tool/asset_baker:
+  //   BakedMeshHeader | uint16 position[3] per vertex | int16 normal[2] per vertex
+  //   | uint32 index[3] per triangle
+  // Positions are quantized over the bounds, normals are octahedral snorm16 with -32768 for none.
+  constexpr auto BAKED_MESH_MAGIC = std::uint32_t{ 0x534D5242 };  // "BRMS"
+  constexpr auto BAKED_MESH_VERSION = std::uint32_t{ 1 };
+
+  struct BakedMeshHeader {
+    std::uint32_t magic{ BAKED_MESH_MAGIC };
+    std::uint32_t version{ BAKED_MESH_VERSION };
+    std::uint32_t vertex_count{ 0 };
+    std::uint32_t triangle_count{ 0 };
+    float min[3]{};
+    float max[3]{};
+  };
+
+  static_assert(sizeof(BakedMeshHeader) == 40, "BakedMeshHeader is part of the file format");
+
+  // ASCII STL, unwelded: three vertices with the facet normal for every facet.
+  auto ParseStl(std::span<const char> data) -> MeshData;
+
+  // Weld duplicate vertices and quantize them, empty for an empty mesh.
+  auto BakeMesh(const MeshData& mesh) -> std::vector<char>;
+
+  // Decode a baked model, empty when the data is malformed.
+  auto ParseBakedMesh(std::span<const char> data) -> MeshData;
+
+  // Baked model or ASCII STL, told apart by the baked header.
+  auto ParseMeshData(std::span<const char> data) -> MeshData;
+
+}  // namespace brabbit
@@ -1,11 +1,56 @@
+#include <algorithm>
+#include <vector>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <brabbit/instance_batcher.hpp>
+#include <brabbit/light.hpp>
 #include <brabbit/model.hpp>
 #include <brabbit/phong_shader.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/shader_registry.hpp>
+#include <brabbit/upload_ring.hpp>
+#include <brabbit/vertex_layout.hpp>
 
 namespace brabbit {
 
+  namespace {
+
+    constexpr auto POSITION_BINDING = 0u;
+    constexpr auto NORMAL_BINDING = 1u;
+
+    // split streams, so edits upload the dirty ranges of each array as they are. Occlusion and
+    // the object index are not streamed, draws read their generic values
+    using DynamicLayout = VertexLayout<VertexAttribute<0, glm::vec3, POSITION_BINDING>,
+                                       VertexAttribute<1, glm::vec3, NORMAL_BINDING>>;
+
+    // Upload the dirty ranges of data, a buffer too small for it is reallocated with room to grow.
+    template <typename _Type>
+    auto UploadRanges(unsigned int buffer,
+                      std::size_t& capacity,
+                      const std::vector<_Type>& data,
+                      DirtyRanges& ranges) -> void {
+      constexpr auto STRIDE = sizeof(_Type);
+
+      if (data.size() > capacity) {
+        capacity = std::max(data.size(), capacity + capacity / 2);
+        glNamedBufferData(buffer, capacity * STRIDE, nullptr, GL_DYNAMIC_DRAW);
+        glNamedBufferSubData(buffer, 0, data.size() * STRIDE, data.data());
+        ranges.clear();
+        return;
+      }
+
+      ranges.clamp(data.size());
+      for (const auto& range : ranges.getRanges()) {
+        UploadBufferData(
+            buffer, range.first * STRIDE, data.data() + range.first, range.count * STRIDE);
+      }
+      ranges.clear();
+    }
+
+  }  // namespace
+
   Model::Model(std::unique_ptr<Mesh>& mesh) : Model{ mesh.get() } {}
 
   Model::Model(Mesh* mesh) : mesh_{ mesh } {
@@ -13,121 +58,203 @@ namespace brabbit {
       return;
     }
 
-    shader_ = LoadCachedShader<PhongShader>();
-
+    shader_ = LoadCachedShader<PhongShader>(PhongShader::AMBIENT_LIGHT);
 
+    if (mesh_->isDynamic()) {
+      createDynamicBuffers();
+      return;
+    }
 
-    // Create and bind a VAO(Vertex Array Object)
-    glGenVertexArrays(1, &vao_);
-
-    // Load attributes in VAO
-    // From now on, any function call in this target will action on our VAO buffer.
-    glBindVertexArray(vao_);
-
-
-
-    // Generate a VBO(Vertex Buffer Object) buffer.
-    // This buffer is use to send Vertex data to GPU from CPU.
-    glGenBuffers(1, &vertex_vbo_);
-
-    // Bind VBO buffer to GL_ARRAY_BUFFER(array buffer) target.
-    // From now on, any function call in this target will action on our VBO buffer.
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_vbo_);
-
-    // Copy real vertices data into VBO buffer.
-    // param 4:
-    // GL_STATIC_DRAW: The data will never or rarely change.
-    // GL_DYNAMIC_DRAW：The data will be changed a lot.
-    // GL_STREAM_DRAW：The data changes every time it is plotted.
-    glBufferData(
-        GL_ARRAY_BUFFER, mesh_->getVerticesSize(), mesh_->getVerticesData(), GL_STATIC_DRAW);
-
-    // EBO/IBO (Element Buffer Object/Index Buffer Object)
-    glGenBuffers(1, &index_ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_ebo_);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER, mesh_->getIndicesSize(), mesh_->getIndicesData(), GL_STATIC_DRAW);
-
-    // Tell GPU how to decode our vertices data.
-    // Set attribute pointer's infomation about our vertices data. (save in VAO)
-    // param 1: [int] location index in vertex shader source: 'layout(location = 0)'
-    // param 2: [int] size of data, 3 means it's a 'vec3' attribute
-    // param 3: [enum] type of data, GL_FLOAT means float (of course..)
-    // param 4: [bool] need to normalize or not, GL_TRUE or GL_FALSE
-    // param 5: [int] stride, data's stride between each group
-    // param 6: [void*] offset, offset of data's begin position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(0));
-    // Make data attribute in location 0 enabled
-    // Call the 'glDisableVertexAttribArray' in some where to disabled it.
-    glEnableVertexAttribArray(0);
-
-
-
-    // VBO for normals, EBO is unnecessary
-    glGenBuffers(1, &normal_vbo_);
-    glBindBuffer(GL_ARRAY_BUFFER, normal_vbo_);
-    glBufferData(GL_ARRAY_BUFFER, mesh_->getNormalsSize(), mesh_->getNormalsData(), GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(0));
-    glEnableVertexAttribArray(1);
+    arena_ = AcquireGeometryArena();
+    geometry_ = arena_->acquire(*mesh_);
   }
 
   Model::~Model() {
-    glDeleteBuffers(1, &vertex_vbo_);
-    glDeleteBuffers(1, &index_ebo_);
-    glDeleteBuffers(1, &normal_vbo_);
+    auto& state = GetRenderState();
+    for (auto& buffers : dynamic_buffers_) {
+      state.forgetBuffer(buffers.vertex_vbo);
+      state.forgetBuffer(buffers.normal_vbo);
+      glDeleteBuffers(1, &buffers.vertex_vbo);
+      glDeleteBuffers(1, &buffers.normal_vbo);
+      glDeleteBuffers(1, &buffers.index_ebo);
+    }
+    state.forgetVertexArray(vao_);
     glDeleteVertexArrays(1, &vao_);
   }
 
+  auto Model::createDynamicBuffers() -> void {
+    glCreateVertexArrays(1, &vao_);
+    DynamicLayout::Apply(vao_);
+
+    // every set starts with the whole mesh, the edits made so far are in it already
+    mesh_->takeChanges();
+    for (auto& buffers : dynamic_buffers_) {
+      glCreateBuffers(1, &buffers.vertex_vbo);
+      glCreateBuffers(1, &buffers.normal_vbo);
+      glCreateBuffers(1, &buffers.index_ebo);
+      glNamedBufferData(
+          buffers.vertex_vbo, mesh_->getVerticesSize(), mesh_->getVerticesData(), GL_DYNAMIC_DRAW);
+      glNamedBufferData(
+          buffers.normal_vbo, mesh_->getNormalsSize(), mesh_->getNormalsData(), GL_DYNAMIC_DRAW);
+      glNamedBufferData(
+          buffers.index_ebo, mesh_->getIndicesSize(), mesh_->getIndicesData(), GL_DYNAMIC_DRAW);
+      buffers.vertex_capacity = mesh_->getVertices().size();
+      buffers.normal_capacity = mesh_->getNormals().size();
+      buffers.index_capacity = mesh_->getIndices().size();
+    }
+
+    // draw() points the bindings at the current set
+    DynamicLayout::BindBuffer(vao_, POSITION_BINDING, dynamic_buffers_[0].vertex_vbo);
+    DynamicLayout::BindBuffer(vao_, NORMAL_BINDING, dynamic_buffers_[0].normal_vbo);
+    glVertexArrayElementBuffer(vao_, dynamic_buffers_[0].index_ebo);
+  }
+
+  auto Model::updateDynamicBuffers() -> void {
+    const auto changes = mesh_->takeChanges();
+    for (auto& buffers : dynamic_buffers_) {
+      buffers.pending.vertices.add(changes.vertices);
+      buffers.pending.normals.add(changes.normals);
+      buffers.pending.indices.add(changes.indices);
+    }
+
+    auto& buffers = dynamic_buffers_[dynamic_frame_++ % DYNAMIC_BUFFER_COUNT];
+    auto& [vertices, normals, indices] = buffers.pending;
+    UploadRanges(buffers.vertex_vbo, buffers.vertex_capacity, mesh_->getVertices(), vertices);
+    UploadRanges(buffers.normal_vbo, buffers.normal_capacity, mesh_->getNormals(), normals);
+    UploadRanges(buffers.index_ebo, buffers.index_capacity, mesh_->getIndices(), indices);
+
+    DynamicLayout::BindBuffer(vao_, POSITION_BINDING, buffers.vertex_vbo);
+    DynamicLayout::BindBuffer(vao_, NORMAL_BINDING, buffers.normal_vbo);
+    glVertexArrayElementBuffer(vao_, buffers.index_ebo);
+  }
+
   auto Model::getMesh() const -> const Mesh* {
     return mesh_;
   }
 
-  auto Model::draw() -> void {
+  auto Model::isAnimated() const -> bool {
+    return animated_;
+  }
+
+  auto Model::setAnimated(bool animated) -> void {
+    animated_ = animated;
+  }
+
+  auto Model::getBounds() const -> Aabb {
+    return mesh_ ? mesh_->getBounds() : Aabb{};
+  }
+
+  auto Model::intersect(const Ray& ray, RayHit& hit) const -> bool {
+    return mesh_ && mesh_->intersect(ray, hit);
+  }
+
+  auto Model::update() -> void {
     if (!mesh_) {
       return;
     }
 
+    auto time = static_cast<float>(glfwGetTime());
+
+    if (animated_) {
+      auto radians = time * glm::radians(50.0f);
+      setModel(glm::rotate(glm::mat4{ 1.0f }, radians, { 0.5f, 1.0f, 0.0f }));
+    }
+
+    // the variant follows the light, the current one keeps drawing until the next one is built
+    const auto* light = scene_->getLight();
+    const auto features = light && light->getAmbientStrength() > 0.0f ? PhongShader::AMBIENT_LIGHT
+                                                                      : ShaderFeatures{ 0 };
+    if (shader_ && shader_->getFeatures() != features) {
+      if (auto* shader = LoadCachedShader<PhongShader>(features); shader && shader->isReady()) {
+        shader_ = shader;
+      }
+    }
+
+    auto r = std::sin(time) / 2.0f + 0.3f;
+    auto g = std::cos(time) / 2.0f + 0.4f;
+    auto b = std::sin(time) / 2.0f + 0.5f;
+    color_ = glm::vec4{ r, g, b, 1.0f };
+    if (scene_->getHovered().object == this) {
+      color_ = glm::mix(color_, glm::vec4{ 1.0f }, 0.5f);
+    }
+  }
+
+  auto Model::submit(InstanceBatcher& batcher) -> bool {
+    if (!mesh_ || !shader_) {
+      return false;
+    }
+
+    // a program still compiling leaves the model out of the frame instead of stalling it
+    if (!shader_->isReady()) {
+      return true;
+    }
+
+    // dynamic meshes draw themselves, but read the same objects buffer
+    object_index_ = batcher.getObjects().add(getScaledModel(), color_);
+    if (!geometry_) {
+      return false;
+    }
+
+    batcher.add(*this, *geometry_, object_index_);
+    return true;
+  }
+
+  auto Model::drawInstances(std::size_t first, std::size_t count) -> void {
     auto* shader = static_cast<PhongShader*>(shader_);
-    if (!shader) {
+    if (!shader || !geometry_) {
       return;
     }
 
     shader->use();
 
-    auto time = static_cast<float>(glfwGetTime());
+    GetRenderState().bindVertexArray(arena_->getVao());
+    arena_->draw(*geometry_, first, count);
+  }
+
+  auto Model::drawIndirect(std::size_t first_command, std::size_t command_count) -> void {
+    auto* shader = static_cast<PhongShader*>(shader_);
+    if (!shader || !arena_) {
+      return;
+    }
 
-    auto radians = time * glm::radians(50.0f);
-    setModel(glm::rotate(glm::mat4{ 1.0f }, radians, { 0.5f, 1.0f, 0.0f }));
-    shader->setModel(getScaledModel());
+    shader->use();
 
-    auto r = std::sin(time) / 2.0f + 0.3f;
-    auto g = std::cos(time) / 2.0f + 0.4f;
-    auto b = std::sin(time) / 2.0f + 0.5f;
-    shader->setObjectColor({ r, g, b, 1.0f });
+    GetRenderState().bindVertexArray(arena_->getVao());
+    arena_->drawIndirect(first_command, command_count);
+  }
+
+  auto Model::draw() -> void {
+    if (!mesh_) {
+      return;
+    }
 
-    if (auto* camera = scene_->getCamera(); camera) {
-      shader->setView(camera->getView());
-      shader->setProjection(camera->getProjection());
-      shader->setCameraPosition(camera->getPosition());
+    auto* shader = static_cast<PhongShader*>(shader_);
+    if (!shader) {
+      return;
     }
 
-    if (auto* light = scene_->getLight(); light) {
-      shader->setLightColor(light->getColor());
-      shader->setLightPosition(light->getPosition());
-      shader->setAmbientStrength(light->getAmbientStrength());
-      shader->setSpecularStrength(light->getSpecularStrength());
+    shader->use();
+
+    // without an instance buffer the object index is read from its generic value
+    shader->setObjectIndex(object_index_);
+
+    if (mesh_->isDynamic()) {
+      updateDynamicBuffers();
     }
 
     // Load attributes in VAO
-    glBindVertexArray(vao_);
+    GetRenderState().bindVertexArray(vao_);
+
+    // A disabled attribute array reads the current generic value, which is context state.
+    glVertexAttrib1f(2, 1.0f);
 
     // Use EBO and VB0 to draw the triangle
     // param 1: [enum] type to draw
     // param 2: [int] index count of element array
     // param 3: [enum] type of index array
     // param 4: [void*] offset of index array
-    glDrawElements(
-        GL_TRIANGLES, mesh_->getIndicesSize(), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+    const auto count = static_cast<GLsizei>(mesh_->getIndices().size() * 3);
+    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
   }
 
 }  // namespace brabbit
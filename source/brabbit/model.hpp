@@ -1,11 +1,19 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <brabbit/geometry_arena.hpp>
 #include <brabbit/mesh.hpp>
 #include <brabbit/scene_object.hpp>
 
 namespace brabbit {
 
   class Model : public SceneObject {
+    friend class InstanceBatcher;
+
    public:
     explicit Model(std::unique_ptr<Mesh>& mesh);
     explicit Model(Mesh* mesh);
@@ -14,14 +22,56 @@ namespace brabbit {
    public:
     auto getMesh() const -> const Mesh*;
 
+    // Spin around a fixed axis, overwriting the model matrix every frame.
+    auto isAnimated() const -> bool;
+    auto setAnimated(bool animated) -> void;
+
+   public:
+    auto getBounds() const -> Aabb override;
+    auto intersect(const Ray& ray, RayHit& hit) const -> bool override;
+
    protected:
+    auto update() -> void override;
+    auto submit(InstanceBatcher& batcher) -> bool override;
     auto draw() -> void override;
 
+   private:
+    // Buffers of a dynamic mesh. Frames alternate between the sets, so an update never writes a
+    // buffer the previous frame may still be reading. Each set keeps the edits it has not seen.
+    struct DynamicBuffers {
+      unsigned int vertex_vbo{ 0 };
+      unsigned int normal_vbo{ 0 };
+      unsigned int index_ebo{ 0 };
+      std::size_t vertex_capacity{ 0 };  // capacities in elements
+      std::size_t normal_capacity{ 0 };
+      std::size_t index_capacity{ 0 };
+      MeshChanges pending{};
+    };
+
+    static constexpr auto DYNAMIC_BUFFER_COUNT = std::size_t{ 2 };
+
+   private:
+    auto createDynamicBuffers() -> void;
+    auto updateDynamicBuffers() -> void;
+
+    // Draw instances of the batcher's instance buffer with this model's shader and arena range.
+    auto drawInstances(std::size_t first, std::size_t count) -> void;
+
+    // Draw commands of the bound draw indirect buffer with this model's shader, any arena range.
+    auto drawIndirect(std::size_t first_command, std::size_t command_count) -> void;
+
    private:
     Mesh* mesh_{ nullptr };
-    unsigned int vertex_vbo_{ 0 };
-    unsigned int index_ebo_{ 0 };
-    unsigned int normal_vbo_{ 0 };
+    bool animated_{ false };
+    glm::vec4 color_{ 1.0f };
+    std::uint32_t object_index_{ 0 };  // into this frame's objects buffer
+
+    // static meshes live in the arena, shared by every model of the same mesh
+    std::shared_ptr<GeometryArena> arena_{ nullptr };
+    std::shared_ptr<const GeometryRange> geometry_{ nullptr };
+
+    std::array<DynamicBuffers, DYNAMIC_BUFFER_COUNT> dynamic_buffers_{};
+    std::size_t dynamic_frame_{ 0 };
   };
 
 }  // namespace brabbit
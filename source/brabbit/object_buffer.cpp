@@ -0,0 +1,83 @@
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <brabbit/object_buffer.hpp>
+#include <brabbit/parallel.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/upload_ring.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    // below this many objects a thread costs more than it saves
+    constexpr auto PARALLEL_THRESHOLD = std::size_t{ 4096 };
+
+    // transpose(inverse(mat3(model))) through the cofactors, three cross products and a dot
+    auto GetNormalMatrix(const glm::mat4& model) -> glm::mat3 {
+      const auto x = glm::vec3{ model[0] };
+      const auto y = glm::vec3{ model[1] };
+      const auto z = glm::vec3{ model[2] };
+
+      const auto yz = glm::cross(y, z);
+      const auto determinant = glm::dot(x, yz);
+      if (determinant == 0.0f) {
+        return glm::mat3{ 1.0f };
+      }
+
+      return glm::mat3{ yz, glm::cross(z, x), glm::cross(x, y) } / determinant;
+    }
+
+  }  // namespace
+
+  ObjectBuffer::ObjectBuffer() {
+    glCreateBuffers(1, &buffer_);
+  }
+
+  ObjectBuffer::~ObjectBuffer() {
+    GetRenderState().forgetBuffer(buffer_);
+    glDeleteBuffers(1, &buffer_);
+  }
+
+  auto ObjectBuffer::add(const glm::mat4& model, const glm::vec4& color) -> std::uint32_t {
+    models_.push_back(model);
+    colors_.push_back(color);
+    return static_cast<std::uint32_t>(models_.size() - 1);
+  }
+
+  auto ObjectBuffer::getCount() const -> std::size_t {
+    return models_.size();
+  }
+
+  auto ObjectBuffer::upload(const glm::mat4& view_projection) -> void {
+    const auto count = models_.size();
+    data_.resize(count);
+
+    ParallelFor(count, PARALLEL_THRESHOLD, [&](auto, auto begin, auto end) {
+      for (auto i = begin; i < end; ++i) {
+        auto& object = data_[i];
+        object.model = models_[i];
+        object.model_view_projection = view_projection * models_[i];
+        object.normal_matrix = glm::mat3x4{ GetNormalMatrix(models_[i]) };
+        object.color = colors_[i];
+      }
+    });
+
+    if (count > 0) {
+      // last frame's draws may still read the old contents, let the driver hand out new storage
+      if (count > capacity_) {
+        capacity_ = std::max(count, capacity_ + capacity_ / 2);
+        glNamedBufferData(buffer_, capacity_ * sizeof(ObjectData), nullptr, GL_STREAM_DRAW);
+      } else {
+        glInvalidateBufferData(buffer_);
+      }
+      UploadBufferData(buffer_, 0, data_.data(), count * sizeof(ObjectData));
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, buffer_);
+    }
+
+    models_.clear();
+    colors_.clear();
+  }
+
+}  // namespace brabbit
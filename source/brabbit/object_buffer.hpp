@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  // Per object record of the objects buffer, std430 layout of Object in phong.vs and cull.cs.
+  struct ObjectData {
+    glm::mat4 model{ 1.0f };
+    glm::mat4 model_view_projection{ 1.0f };
+    glm::mat3x4 normal_matrix{ 1.0f };  // std430 pads mat3 columns to vec4
+    glm::vec4 color{ 1.0f };
+  };
+
+  // Everything the shaders need to know about the objects of a frame, in one storage buffer.
+  // Objects are added while submitting, then a single pass derives the matrices of all of them
+  // on the CPU and uploads the buffer once, shaders index it with the object index.
+  class ObjectBuffer {
+   public:
+    explicit ObjectBuffer();
+    virtual ~ObjectBuffer();
+
+    ObjectBuffer(const ObjectBuffer&) = delete;
+    auto operator=(const ObjectBuffer&) -> ObjectBuffer& = delete;
+
+   public:
+    // Index of the object in this frame's buffer.
+    auto add(const glm::mat4& model, const glm::vec4& color) -> std::uint32_t;
+    auto getCount() const -> std::size_t;
+
+    // Derive and upload the objects added so far and bind them to BINDING, the next add starts
+    // the next frame.
+    auto upload(const glm::mat4& view_projection) -> void;
+
+   public:
+    static constexpr auto BINDING = 0u;
+
+   private:
+    std::vector<glm::mat4> models_{};
+    std::vector<glm::vec4> colors_{};
+    std::vector<ObjectData> data_{};
+
+    unsigned int buffer_{ 0 };
+    std::size_t capacity_{ 0 };  // in objects
+  };
+
+}  // namespace brabbit
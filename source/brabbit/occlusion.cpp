@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <brabbit/occlusion.hpp>
+#include <brabbit/parallel.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto GRAIN = std::size_t{ 256 };
+    constexpr auto TWO_PI = 6.28318530718f;
+
+    // Rays of one vertex are traced together, lanes are kept in separate arrays so the loops
+    // over them compile to SIMD instructions.
+    constexpr auto PACKET_SIZE = std::size_t{ 8 };
+
+    using Lanes = std::array<float, PACKET_SIZE>;
+
+    // Rays sharing an origin. far is the remaining range of each lane, -1 once it is occluded.
+    struct Packet {
+      glm::vec3 origin{ 0.0f, 0.0f, 0.0f };
+      float near{ 0.0f };
+      Lanes x{}, y{}, z{};
+      Lanes inverse_x{}, inverse_y{}, inverse_z{};
+      Lanes far{};
+    };
+
+    auto Inverse(float value) -> float {
+      // finite inverse, 0 * inf in the slab test would give NaN for rays on a slab plane
+      constexpr auto TINY = 1e-30f;
+      return 1.0f / (std::abs(value) > TINY ? value : std::copysign(TINY, value));
+    }
+
+    // Nearest entry of any lane into the box, +inf when every lane misses it.
+    auto IntersectBox(const Packet& packet, const Bvh::Node& node) -> float {
+      constexpr auto MISS = std::numeric_limits<float>::infinity();
+
+      // no short circuits or initializer lists in the lane loops, they keep them from vectorizing
+      auto entries = Lanes{};
+      for (auto lane = std::size_t{ 0 }; lane < PACKET_SIZE; ++lane) {
+        const auto x0 = (node.min.x - packet.origin.x) * packet.inverse_x[lane];
+        const auto x1 = (node.max.x - packet.origin.x) * packet.inverse_x[lane];
+        const auto y0 = (node.min.y - packet.origin.y) * packet.inverse_y[lane];
+        const auto y1 = (node.max.y - packet.origin.y) * packet.inverse_y[lane];
+        const auto z0 = (node.min.z - packet.origin.z) * packet.inverse_z[lane];
+        const auto z1 = (node.max.z - packet.origin.z) * packet.inverse_z[lane];
+
+        const auto entry = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+                                    std::max(std::min(z0, z1), 0.0f));
+        const auto exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+        const auto hit = (entry <= exit) & (entry <= packet.far[lane]);
+        entries[lane] = hit ? entry : MISS;
+      }
+      return *std::min_element(entries.begin(), entries.end());
+    }
+
+    // Moller-Trumbore for every lane. The shared origin makes s, q and the distance numerator
+    // scalars, only the terms depending on the direction are computed per lane.
+    auto IntersectTriangle(Packet& packet,
+                           const glm::vec3& a,
+                           const glm::vec3& b,
+                           const glm::vec3& c) -> void {
+      constexpr auto EPSILON = 1e-9f;
+
+      const auto edge1 = b - a;
+      const auto edge2 = c - a;
+      const auto s = packet.origin - a;
+      const auto q = glm::cross(s, edge1);
+      const auto numerator = glm::dot(edge2, q);
+
+      for (auto lane = std::size_t{ 0 }; lane < PACKET_SIZE; ++lane) {
+        const auto px = packet.y[lane] * edge2.z - packet.z[lane] * edge2.y;
+        const auto py = packet.z[lane] * edge2.x - packet.x[lane] * edge2.z;
+        const auto pz = packet.x[lane] * edge2.y - packet.y[lane] * edge2.x;
+        const auto determinant = edge1.x * px + edge1.y * py + edge1.z * pz;
+        const auto inverse = 1.0f / determinant;
+
+        const auto u = (s.x * px + s.y * py + s.z * pz) * inverse;
+        const auto v =
+            (packet.x[lane] * q.x + packet.y[lane] * q.y + packet.z[lane] * q.z) * inverse;
+        const auto distance = numerator * inverse;
+
+        const auto hit = (std::abs(determinant) > EPSILON) & (u >= 0.0f) & (v >= 0.0f) &
+                         (u + v <= 1.0f) & (distance > packet.near) &
+                         (distance < packet.far[lane]);
+        packet.far[lane] = hit ? -1.0f : packet.far[lane];
+      }
+    }
+
+    auto IsDone(const Packet& packet) -> bool {
+      auto done = true;
+      for (auto lane = std::size_t{ 0 }; lane < PACKET_SIZE; ++lane) {
+        done &= packet.far[lane] < 0.0f;
+      }
+      return done;
+    }
+
+    // Any hit traversal, stops once every lane is occluded.
+    auto Trace(const Mesh& mesh, const Bvh& bvh, Packet& packet) -> void {
+      const auto& nodes = bvh.getNodes();
+      const auto& primitives = bvh.getPrimitives();
+      const auto& vertices = mesh.getVertices();
+      const auto& indices = mesh.getIndices();
+      constexpr auto MISS = std::numeric_limits<float>::infinity();
+      if (nodes.empty() || IntersectBox(packet, nodes.front()) == MISS) {
+        return;
+      }
+
+      auto stack = std::array<std::uint32_t, 64>{};
+      auto top = std::size_t{ 0 };
+      stack[top++] = 0;
+
+      while (top > 0) {
+        const auto& node = nodes[stack[--top]];
+
+        if (node.count > 0) {
+          for (auto i = node.index; i < node.index + node.count; ++i) {
+            const auto& triangle = indices[primitives[i]];
+            IntersectTriangle(
+                packet, vertices[triangle.x], vertices[triangle.y], vertices[triangle.z]);
+          }
+          if (IsDone(packet)) {
+            return;
+          }
+          continue;
+        }
+
+        // nearest child first, close occluders end the packet early
+        auto near = node.index;
+        auto far = node.index + 1;
+        auto near_distance = IntersectBox(packet, nodes[near]);
+        auto far_distance = IntersectBox(packet, nodes[far]);
+        if (far_distance < near_distance) {
+          std::swap(near, far);
+          std::swap(near_distance, far_distance);
+        }
+
+        if (far_distance != MISS) {
+          stack[top++] = far;
+        }
+        if (near_distance != MISS) {
+          stack[top++] = near;
+        }
+      }
+    }
+
+    // Cosine weighted stratified directions around +Z, grouped into packets of neighboring
+    // directions: the hemisphere is cut into elevation bands times azimuth sectors, one tile per
+    // packet, and every tile holds a 2 x 4 grid of samples.
+    auto GetSampleDirections(std::size_t packets) -> std::vector<glm::vec3> {
+      auto bands = std::size_t{ 1 };
+      for (auto i = std::size_t{ 1 }; i * i * 2 <= packets; ++i) {
+        if (packets % i == 0) {
+          bands = i;
+        }
+      }
+      const auto sectors = packets / bands;
+
+      auto directions = std::vector<glm::vec3>{};
+      directions.reserve(packets * PACKET_SIZE);
+      for (auto band = std::size_t{ 0 }; band < bands; ++band) {
+        for (auto sector = std::size_t{ 0 }; sector < sectors; ++sector) {
+          for (auto lane = std::size_t{ 0 }; lane < PACKET_SIZE; ++lane) {
+            const auto row = (static_cast<float>(lane / 4) + 0.5f) / 2.0f;
+            const auto column = (static_cast<float>(lane % 4) + 0.5f) / 4.0f;
+            const auto u = (static_cast<float>(band) + row) / static_cast<float>(bands);
+            const auto v = (static_cast<float>(sector) + column) / static_cast<float>(sectors);
+            const auto radius = std::sqrt(u);
+            directions.emplace_back(radius * std::cos(TWO_PI * v),
+                                    radius * std::sin(TWO_PI * v),
+                                    std::sqrt(std::max(0.0f, 1.0f - u)));
+          }
+        }
+      }
+      return directions;
+    }
+
+  }  // namespace
+
+  auto BakeAmbientOcclusion(const Mesh& mesh, int samples, float max_distance)
+      -> std::vector<float> {
+    const auto& vertices = mesh.getVertices();
+    const auto& normals = mesh.getNormals();
+    if (vertices.empty() || normals.size() != vertices.size() || samples <= 0) {
+      return {};
+    }
+
+    // fetched once, every packet walks the same tree
+    const auto& bvh = mesh.getBvh();
+    const auto bounds = bvh.getBounds();
+    const auto diagonal = glm::length(bounds.getExtent());
+    if (max_distance <= 0.0f) {
+      max_distance = diagonal * 0.25f;
+    }
+
+    // whole packets only, the extra rays are cheap next to the BVH walk
+    const auto packets = (static_cast<std::size_t>(samples) + PACKET_SIZE - 1) / PACKET_SIZE;
+    const auto directions = GetSampleDirections(packets);
+    const auto bias = diagonal * 1e-5f;
+
+    // files may leave normals zero, those vertices use the area weighted normal of their triangles
+    auto surface_normals = std::vector<glm::vec3>{};
+    const auto has_normal = [&](std::size_t i) { return glm::dot(normals[i], normals[i]) > 0.0f; };
+    for (auto i = std::size_t{ 0 }; i < vertices.size() && surface_normals.empty(); ++i) {
+      if (!has_normal(i)) {
+        surface_normals.resize(vertices.size(), glm::vec3{ 0.0f });
+        for (const auto& triangle : mesh.getIndices()) {
+          const auto normal = glm::cross(vertices[triangle.y] - vertices[triangle.x],
+                                         vertices[triangle.z] - vertices[triangle.x]);
+          surface_normals[triangle.x] += normal;
+          surface_normals[triangle.y] += normal;
+          surface_normals[triangle.z] += normal;
+        }
+      }
+    }
+
+    auto occlusion = std::vector<float>(vertices.size(), 1.0f);
+    ParallelFor(vertices.size(), GRAIN, [&](auto, auto begin, auto end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto& given = has_normal(i) ? normals[i] : surface_normals[i];
+        const auto length = glm::length(given);
+        if (!(length > 0.0f)) {
+          continue;
+        }
+
+        // orthonormal frame around the normal (Duff et al. 2017), turned by a per vertex angle
+        // so neighboring vertices do not share the same sample pattern
+        const auto normal = given / length;
+        const auto sign = std::copysign(1.0f, normal.z);
+        const auto a = -1.0f / (sign + normal.z);
+        const auto b = normal.x * normal.y * a;
+        const auto tangent =
+            glm::vec3{ 1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x };
+        const auto bitangent = glm::vec3{ b, sign + normal.y * normal.y * a, -normal.y };
+
+        const auto hash = static_cast<std::uint32_t>(i) * 0x9E3779B9u >> 16;
+        const auto angle = static_cast<float>(hash) / 65536.0f * TWO_PI;
+        const auto rotated_tangent = tangent * std::cos(angle) + bitangent * std::sin(angle);
+        const auto rotated_bitangent = glm::cross(normal, rotated_tangent);
+
+        auto open = 0;
+        auto packet = Packet{};
+        packet.origin = vertices[i] + normal * bias;
+        packet.near = bias;
+        for (auto first = std::size_t{ 0 }; first < directions.size(); first += PACKET_SIZE) {
+          for (auto lane = std::size_t{ 0 }; lane < PACKET_SIZE; ++lane) {
+            const auto& local = directions[first + lane];
+            const auto direction =
+                rotated_tangent * local.x + rotated_bitangent * local.y + normal * local.z;
+            packet.x[lane] = direction.x;
+            packet.y[lane] = direction.y;
+            packet.z[lane] = direction.z;
+            packet.inverse_x[lane] = Inverse(direction.x);
+            packet.inverse_y[lane] = Inverse(direction.y);
+            packet.inverse_z[lane] = Inverse(direction.z);
+            packet.far[lane] = max_distance;
+          }
+
+          Trace(mesh, bvh, packet);
+          open += static_cast<int>(std::count_if(
+              packet.far.begin(), packet.far.end(), [](float far) { return far >= 0.0f; }));
+        }
+
+        occlusion[i] = static_cast<float>(open) / static_cast<float>(directions.size());
+      }
+    });
+
+    return occlusion;
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/mesh.hpp>
+
+namespace brabbit {
+
+  // Per vertex ambient occlusion, 1 for fully open vertices and 0 for fully occluded ones.
+  // Every vertex casts `samples` cosine weighted rays over the hemisphere of its normal against
+  // the triangle BVH of the mesh, rays hitting anything closer than max_distance are occluded.
+  // max_distance <= 0 uses a quarter of the diagonal of the mesh bounds.
+  auto BakeAmbientOcclusion(const Mesh& mesh, int samples = 64, float max_distance = 0.0f)
+      -> std::vector<float>;
+
+}  // namespace brabbit
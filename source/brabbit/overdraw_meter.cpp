@@ -0,0 +1,71 @@
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include <brabbit/overdraw_meter.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto SHADED = static_cast<std::size_t>(OverdrawMeter::Count::SHADED);
+    constexpr auto VISIBLE = static_cast<std::size_t>(OverdrawMeter::Count::VISIBLE);
+
+  }  // namespace
+
+  OverdrawMeter::OverdrawMeter() {
+    for (auto& frame : frames_) {
+      glCreateQueries(
+          GL_SAMPLES_PASSED, static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+  }
+
+  OverdrawMeter::~OverdrawMeter() {
+    for (auto& frame : frames_) {
+      glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+  }
+
+  auto OverdrawMeter::begin(Count count) -> void {
+    const auto index = static_cast<std::size_t>(count);
+    auto& frame = frames_[frame_];
+    glBeginQuery(GL_SAMPLES_PASSED, frame.queries[index]);
+    frame.issued[index] = true;
+  }
+
+  auto OverdrawMeter::end() -> void {
+    glEndQuery(GL_SAMPLES_PASSED);
+  }
+
+  auto OverdrawMeter::endFrame() -> void {
+    frame_ = (frame_ + 1) % FRAME_COUNT;
+
+    // the oldest frame, its queries are reused from here on whether they finished or not
+    auto& frame = frames_[frame_];
+    const auto complete = frame.issued[SHADED] && frame.issued[VISIBLE];
+    frame.issued = {};
+    if (!complete) {
+      return;
+    }
+
+    auto available = GLuint{ GL_FALSE };
+    glGetQueryObjectuiv(frame.queries[VISIBLE], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+      return;
+    }
+
+    // the shaded samples were counted before the visible ones, so those are ready too
+    auto shaded = GLuint64{ 0 };
+    auto visible = GLuint64{ 0 };
+    glGetQueryObjectui64v(frame.queries[SHADED], GL_QUERY_RESULT, &shaded);
+    glGetQueryObjectui64v(frame.queries[VISIBLE], GL_QUERY_RESULT, &visible);
+    if (visible > 0) {
+      factor_ = static_cast<float>(static_cast<double>(shaded) / static_cast<double>(visible));
+    }
+  }
+
+  auto OverdrawMeter::getFactor() const -> float {
+    return factor_;
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace brabbit {
+
+  // Overdraw of the opaque passes, counted with GL_SAMPLES_PASSED queries: samples that passed
+  // the depth test in submission order, which are the ones a fragment shader ran for, over the
+  // samples left visible at the end. Results are read a few frames later and only once the GPU
+  // has them, so measuring never waits.
+  class OverdrawMeter {
+   public:
+    explicit OverdrawMeter();
+    virtual ~OverdrawMeter();
+
+    OverdrawMeter(const OverdrawMeter&) = delete;
+    auto operator=(const OverdrawMeter&) -> OverdrawMeter& = delete;
+
+   public:
+    enum class Count : std::size_t {
+      SHADED,   // samples passing the depth test, a fragment shader ran for each
+      VISIBLE,  // samples the finished frame shows
+    };
+
+    // Count the samples passing between begin and end, one query of each kind per frame at most.
+    auto begin(Count count) -> void;
+    auto end() -> void;
+
+    // Pick up finished results and move on to the next frame's queries.
+    auto endFrame() -> void;
+
+    // Shaded over visible samples of the last finished frame that counted both, 1 for a scene
+    // without any overdraw, 0 before the first result.
+    auto getFactor() const -> float;
+
+   private:
+    static constexpr auto FRAME_COUNT = std::size_t{ 4 };
+
+    struct Frame {
+      std::array<unsigned int, 2> queries{};
+      std::array<bool, 2> issued{};
+    };
+
+   private:
+    std::array<Frame, FRAME_COUNT> frames_{};
+    std::size_t frame_{ 0 };
+    float factor_{ 0.0f };
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace brabbit {
+
+  // Resource pack layout, little endian, written by tool/resource_packer:
+  //   PackHeader | PackEntry[entry_count] sorted by hash | names | blobs at PACK_ALIGNMENT
+  // Names are the paths below the resource directory with '/' separators, e.g. "model/cube.stl".
+  constexpr auto PACK_MAGIC = std::uint32_t{ 0x4B505242 };  // "BRPK"
+  constexpr auto PACK_VERSION = std::uint32_t{ 1 };
+  constexpr auto PACK_ALIGNMENT = std::uint64_t{ 64 };
+
+  enum class PackCompression : std::uint32_t {
+    NONE,
+    LZ,  // see CompressLz
+  };
+
+  struct PackHeader {
+    std::uint32_t magic{ PACK_MAGIC };
+    std::uint32_t version{ PACK_VERSION };
+    std::uint32_t entry_count{ 0 };
+    std::uint32_t reserved{ 0 };
+    std::uint64_t names_offset{ 0 };
+    std::uint64_t names_size{ 0 };
+  };
+
+  struct PackEntry {
+    std::uint64_t hash{ 0 };
+    std::uint64_t offset{ 0 };       // of the blob from the start of the pack
+    std::uint64_t stored_size{ 0 };  // of the blob
+    std::uint64_t size{ 0 };         // after decompression
+    std::uint32_t name_offset{ 0 };  // into the names
+    std::uint32_t name_size{ 0 };
+    PackCompression compression{ PackCompression::NONE };
+    std::uint32_t reserved{ 0 };
+  };
+
+  static_assert(sizeof(PackHeader) == 32, "PackHeader is part of the file format");
+  static_assert(sizeof(PackEntry) == 48, "PackEntry is part of the file format");
+
+  // FNV-1a, entries are found by binary search over it.
+  constexpr auto HashResourceName(std::string_view name) -> std::uint64_t {
+    auto hash = std::uint64_t{ 0xCBF29CE484222325 };
+    for (const auto ch : name) {
+      hash = (hash ^ static_cast<std::uint8_t>(ch)) * 0x100000001B3;
+    }
+    return hash;
+  }
+
+}  // namespace brabbit
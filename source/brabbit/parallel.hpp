@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace brabbit {
+
+  // Number of chunks ParallelFor splits `count` items into, never more than the hardware threads.
+  inline auto GetParallelChunkCount(std::size_t count, std::size_t grain) -> std::size_t {
+    const auto workers = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    const auto chunks = (count + std::max<std::size_t>(1, grain) - 1) / std::max<std::size_t>(1, grain);
+    return std::min(workers, chunks);
+  }
+
+  // Split [0, count) into contiguous chunks of at least `grain` items and run them concurrently.
+  // function: (std::size_t chunk, std::size_t begin, std::size_t end) -> void
+  // The calling thread processes the first chunk and returns once every chunk is done.
+  template <typename _Function>
+  auto ParallelFor(std::size_t count, std::size_t grain, _Function&& function) -> void {
+    const auto chunks = GetParallelChunkCount(count, grain);
+    if (chunks == 0) {
+      return;
+    }
+
+    if (chunks == 1) {
+      function(std::size_t{ 0 }, std::size_t{ 0 }, count);
+      return;
+    }
+
+    const auto chunk_size = (count + chunks - 1) / chunks;
+
+    auto threads = std::vector<std::jthread>{};
+    threads.reserve(chunks - 1);
+    for (auto chunk = std::size_t{ 1 }; chunk < chunks; ++chunk) {
+      const auto begin = std::min(count, chunk * chunk_size);
+      const auto end = std::min(count, begin + chunk_size);
+      threads.emplace_back([&function, chunk, begin, end] { function(chunk, begin, end); });
+    }
+
+    function(std::size_t{ 0 }, std::size_t{ 0 }, std::min(count, chunk_size));
+  }
+
+}  // namespace brabbit
@@ -1,26 +1,23 @@
 #pragma once
 
+#include <cstdint>
+
 #include <brabbit/shader.hpp>
 
 namespace brabbit {
 
   class PhongShader : public Shader {
    public:
-    explicit PhongShader();
+    // Ambient and specular terms, compiled out for a light without ambient strength.
+    static constexpr auto AMBIENT_LIGHT = ShaderFeatures{ 1 } << 0;
+
+    explicit PhongShader(ShaderFeatures features = 0);
     virtual ~PhongShader() override;
 
    public:
-    auto setModel(const glm::mat4& model) const -> void;
-    auto setView(const glm::mat4& view) const -> void;
-    auto setProjection(const glm::mat4& projection) const -> void;
-
-    auto setAmbientStrength(float ambient_strength) const -> void;
-    auto setSpecularStrength(float specular_strength) const -> void;
-
-    auto setObjectColor(const glm::vec4& color) const -> void;
-    auto setLightColor(const glm::vec4& color) const -> void;
-    auto setLightPosition(const glm::vec3& position) const -> void;
-    auto setCameraPosition(const glm::vec3& position) const -> void;
+    // Object index into the objects buffer, a per instance attribute. This sets the generic value
+    // read by draws whose VAO does not stream it, which is context state, not program state.
+    auto setObjectIndex(std::uint32_t index) const -> void;
   };
 
 }  // namespace brabbit
@@ -0,0 +1,145 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <brabbit/asset_io.hpp>
+#include <brabbit/program_cache.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  namespace {
+
+    constexpr auto CACHE_MAGIC = std::array{ 'B', 'R', 'P', 'B' };
+    constexpr auto CACHE_VERSION = std::uint32_t{ 1 };
+
+    struct ProgramCacheHeader {
+      std::array<char, 4> magic{ CACHE_MAGIC };
+      std::uint32_t version{ CACHE_VERSION };
+      std::uint64_t key{ 0 };     // sources and driver identity, also the file name
+      std::uint64_t driver{ 0 };  // GL_VERSION, which carries the driver version
+      std::uint32_t format{ 0 };  // binary format of glGetProgramBinary
+      std::uint32_t size{ 0 };    // bytes of binary following the header
+    };
+
+    // FNV-1a continued from hash, strings are terminated so "ab" + "c" differs from "a" + "bc"
+    auto Hash(std::uint64_t hash, std::string_view data) -> std::uint64_t {
+      for (const auto character : data) {
+        hash = (hash ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+      }
+      return (hash ^ 0xffu) * 1099511628211ull;
+    }
+
+    auto GetString(GLenum name) -> std::string_view {
+      const auto* string = reinterpret_cast<const char*>(glGetString(name));
+      return string ? std::string_view{ string } : std::string_view{};
+    }
+
+    auto IsSupported() -> bool {
+      auto formats = GLint{ 0 };
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+      return formats > 0;
+    }
+
+    auto GetKey(std::span<const std::string> sources) -> std::uint64_t {
+      auto key = Hash(14695981039346656037ull, GetString(GL_VENDOR));
+      key = Hash(key, GetString(GL_RENDERER));
+      for (const auto& source : sources) {
+        key = Hash(key, source);
+      }
+      return key;
+    }
+
+    auto GetDriver() -> std::uint64_t {
+      return Hash(14695981039346656037ull, GetString(GL_VERSION));
+    }
+
+    auto GetCachePath(std::uint64_t key) -> std::filesystem::path {
+      auto name = std::array<char, 24>{};
+      std::snprintf(name.data(), name.size(), "%016llx.bin", static_cast<unsigned long long>(key));
+      return GetProgramCacheRoot() / name.data();
+    }
+
+  }  // namespace
+
+  auto GetProgramCacheRoot() -> const std::filesystem::path& {
+    static const auto Root = GetResourceRoot().parent_path() / "shader_cache"sv;
+    return Root;
+  }
+
+  auto LoadProgramBinary(GLuint program, std::span<const std::string> sources) -> bool {
+    if (!IsSupported()) {
+      return false;
+    }
+
+    const auto key = GetKey(sources);
+    const auto file = ReadFile(GetCachePath(key));
+    auto header = ProgramCacheHeader{};
+    if (file.size() < sizeof(header)) {
+      return false;
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key ||
+        header.driver != GetDriver() || header.size != file.size() - sizeof(header)) {
+      return false;
+    }
+
+    glProgramBinary(program,
+                    static_cast<GLenum>(header.format),
+                    file.data() + sizeof(header),
+                    static_cast<GLsizei>(header.size));
+
+    auto linked = GLint{ GL_FALSE };
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+  }
+
+  auto StoreProgramBinary(GLuint program, std::span<const std::string> sources) -> void {
+    if (!IsSupported()) {
+      return;
+    }
+
+    auto linked = GLint{ GL_FALSE };
+    auto length = GLint{ 0 };
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked != GL_TRUE || length <= 0) {
+      return;
+    }
+
+    auto binary = std::vector<char>(static_cast<std::size_t>(length));
+    auto format = GLenum{ 0 };
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    const auto key = GetKey(sources);
+    const auto header = ProgramCacheHeader{
+      CACHE_MAGIC, CACHE_VERSION, key, GetDriver(), format, static_cast<std::uint32_t>(length)
+    };
+
+    // written aside and renamed, so a concurrent run never reads half a file
+    auto error = std::error_code{};
+    std::filesystem::create_directories(GetProgramCacheRoot(), error);
+    const auto path = GetCachePath(key);
+    auto temporary = path;
+    temporary += ".tmp"sv;
+    {
+      auto stream = std::ofstream{ temporary, std::ios::binary | std::ios::trunc };
+      stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      stream.write(binary.data(), length);
+      if (!stream) {
+        stream.close();
+        std::filesystem::remove(temporary, error);
+        return;
+      }
+    }
+    std::filesystem::rename(temporary, path, error);
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+
+#include <glad/glad.h>
+
+namespace brabbit {
+
+  // Linked program binaries kept on disk between runs, keyed by the program's sources, the GL
+  // vendor and the renderer. A binary made by another driver version, or one the driver refuses,
+  // counts as a miss and is replaced by the next store.
+  auto GetProgramCacheRoot() -> const std::filesystem::path&;
+
+  // Link program from the cache, false when it has to be built from source.
+  auto LoadProgramBinary(GLuint program, std::span<const std::string> sources) -> bool;
+
+  // Cache a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+  auto StoreProgramBinary(GLuint program, std::span<const std::string> sources) -> void;
+
+}  // namespace brabbit
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <optional>
+
+namespace brabbit {
+
+  // First fit free list over a linear space of elements. Neighbouring free blocks are joined on
+  // release, so the list only holds real holes.
+  class RangeAllocator {
+   public:
+    explicit RangeAllocator(std::size_t capacity = 0) {
+      grow(capacity);
+    }
+
+   public:
+    auto getCapacity() const -> std::size_t {
+      return capacity_;
+    }
+
+    auto getUsed() const -> std::size_t {
+      return used_;
+    }
+
+    auto getLargestFree() const -> std::size_t {
+      auto largest = std::size_t{ 0 };
+      for (const auto& [first, count] : free_) {
+        largest = std::max(largest, count);
+      }
+      return largest;
+    }
+
+    // 0 when the free space is one block, towards 1 the more it is split into small holes.
+    auto getFragmentation() const -> float {
+      const auto free = capacity_ - used_;
+      return free ? 1.0f - static_cast<float>(getLargestFree()) / static_cast<float>(free) : 0.0f;
+    }
+
+    // Lowest offset with room for `count` elements, empty when no block is large enough.
+    auto allocate(std::size_t count) -> std::optional<std::size_t> {
+      if (count == 0) {
+        return std::size_t{ 0 };
+      }
+
+      for (auto iter = free_.begin(); iter != free_.end(); ++iter) {
+        const auto [first, size] = *iter;
+        if (size < count) {
+          continue;
+        }
+
+        free_.erase(iter);
+        if (size > count) {
+          free_.emplace(first + count, size - count);
+        }
+        used_ += count;
+        return first;
+      }
+      return std::nullopt;
+    }
+
+    auto release(std::size_t first, std::size_t count) -> void {
+      if (count == 0) {
+        return;
+      }
+
+      used_ -= count;
+      auto next = free_.lower_bound(first);
+      if (next != free_.end() && first + count == next->first) {
+        count += next->second;
+        next = free_.erase(next);
+      }
+      if (next != free_.begin()) {
+        if (auto previous = std::prev(next); previous->first + previous->second == first) {
+          previous->second += count;
+          return;
+        }
+      }
+      free_.emplace(first, count);
+    }
+
+    // Add room at the end, allocations keep their offsets.
+    auto grow(std::size_t capacity) -> void {
+      if (capacity <= capacity_) {
+        return;
+      }
+
+      const auto first = capacity_;
+      capacity_ = capacity;
+      used_ += capacity - first;
+      release(first, capacity - first);
+    }
+
+   private:
+    std::size_t capacity_{ 0 };
+    std::size_t used_{ 0 };
+    std::map<std::size_t, std::size_t> free_{};  // first -> count
+  };
+
+}  // namespace brabbit
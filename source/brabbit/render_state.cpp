@@ -0,0 +1,125 @@
+#include <brabbit/render_state.hpp>
+
+namespace brabbit {
+
+  auto RenderState::useProgram(GLuint program) -> void {
+    if (change(program_, program)) {
+      glUseProgram(program);
+    }
+  }
+
+  auto RenderState::bindVertexArray(GLuint vao) -> void {
+    if (change(vao_, vao)) {
+      glBindVertexArray(vao);
+    }
+  }
+
+  auto RenderState::bindBuffer(GLenum target, GLuint buffer) -> void {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+      ++counters_.issued;
+      glBindBuffer(target, buffer);
+      return;
+    }
+
+    if (change(buffers_[target], buffer)) {
+      glBindBuffer(target, buffer);
+    }
+  }
+
+  auto RenderState::setEnabled(GLenum capability, bool enabled) -> void {
+    if (!change(capabilities_[capability], enabled)) {
+      return;
+    }
+
+    if (enabled) {
+      glEnable(capability);
+    } else {
+      glDisable(capability);
+    }
+  }
+
+  auto RenderState::setColorMask(bool enabled) -> void {
+    if (change(color_mask_, enabled)) {
+      const auto mask = enabled ? GL_TRUE : GL_FALSE;
+      glColorMask(mask, mask, mask, mask);
+    }
+  }
+
+  auto RenderState::setDepthMask(bool enabled) -> void {
+    if (change(depth_mask_, enabled)) {
+      glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+  }
+
+  auto RenderState::setDepthFunc(GLenum function) -> void {
+    if (change(depth_func_, function)) {
+      glDepthFunc(function);
+    }
+  }
+
+  auto RenderState::setBlendFunc(GLenum source, GLenum destination) -> void {
+    if (change(blend_func_, std::array{ source, destination })) {
+      glBlendFunc(source, destination);
+    }
+  }
+
+  auto RenderState::setCullFace(GLenum face) -> void {
+    if (change(cull_face_, face)) {
+      glCullFace(face);
+    }
+  }
+
+  auto RenderState::setViewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void {
+    if (change(viewport_, std::array{ x, y, width, height })) {
+      glViewport(x, y, width, height);
+    }
+  }
+
+  auto RenderState::forgetProgram(GLuint program) -> void {
+    if (program_ == program) {
+      program_.reset();
+    }
+  }
+
+  auto RenderState::forgetVertexArray(GLuint vao) -> void {
+    if (vao_ == vao) {
+      vao_.reset();
+    }
+  }
+
+  auto RenderState::forgetBuffer(GLuint buffer) -> void {
+    for (auto& [target, bound] : buffers_) {
+      if (bound == buffer) {
+        bound.reset();
+      }
+    }
+  }
+
+  auto RenderState::invalidate() -> void {
+    program_.reset();
+    vao_.reset();
+    buffers_.clear();
+    capabilities_.clear();
+    color_mask_.reset();
+    depth_mask_.reset();
+    depth_func_.reset();
+    blend_func_.reset();
+    cull_face_.reset();
+    viewport_.reset();
+  }
+
+  auto RenderState::getFrameCounters() const -> const RenderStateCounters& {
+    return frame_counters_;
+  }
+
+  auto RenderState::endFrame() -> void {
+    frame_counters_ = counters_;
+    counters_ = {};
+  }
+
+  auto GetRenderState() -> RenderState& {
+    static auto State = RenderState{};
+    return State;
+  }
+
+}  // namespace brabbit
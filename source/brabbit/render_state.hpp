@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <optional>
+
+#include <glad/glad.h>
+
+namespace brabbit {
+
+  struct RenderStateCounters {
+    std::size_t issued{ 0 };  // calls that reached GL
+    std::size_t elided{ 0 };  // calls dropped because GL already had the value
+  };
+
+  // Shadow of the GL state the renderer changes, a call that would set what is already set never
+  // reaches the driver. Everything starts unknown, so the first call of each kind is issued. All
+  // changes to the tracked state have to go through here or be followed by invalidate().
+  class RenderState {
+   public:
+    explicit RenderState() = default;
+
+   public:
+    auto useProgram(GLuint program) -> void;
+    auto bindVertexArray(GLuint vao) -> void;
+
+    // Element array bindings belong to the bound VAO, those always reach GL.
+    auto bindBuffer(GLenum target, GLuint buffer) -> void;
+
+    auto setEnabled(GLenum capability, bool enabled) -> void;
+    auto setColorMask(bool enabled) -> void;
+    auto setDepthMask(bool enabled) -> void;
+    auto setDepthFunc(GLenum function) -> void;
+    auto setBlendFunc(GLenum source, GLenum destination) -> void;
+    auto setCullFace(GLenum face) -> void;
+    auto setViewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void;
+
+    // GL unbinds deleted objects and may hand their names out again, deleters report them here.
+    auto forgetProgram(GLuint program) -> void;
+    auto forgetVertexArray(GLuint vao) -> void;
+    auto forgetBuffer(GLuint buffer) -> void;
+
+    // Issue everything again, after code outside changed state behind the shadow's back.
+    auto invalidate() -> void;
+
+    // Counters of the last finished frame, endFrame starts the next one.
+    auto getFrameCounters() const -> const RenderStateCounters&;
+    auto endFrame() -> void;
+
+   private:
+    // true when value differs from the shadow and has to be issued
+    template <typename _Type>
+    auto change(std::optional<_Type>& shadow, const _Type& value) -> bool {
+      if (shadow && *shadow == value) {
+        ++counters_.elided;
+        return false;
+      }
+
+      shadow = value;
+      ++counters_.issued;
+      return true;
+    }
+
+   private:
+    std::optional<GLuint> program_{};
+    std::optional<GLuint> vao_{};
+    std::map<GLenum, std::optional<GLuint>> buffers_{};
+
+    std::map<GLenum, std::optional<bool>> capabilities_{};
+    std::optional<bool> color_mask_{};
+    std::optional<bool> depth_mask_{};
+    std::optional<GLenum> depth_func_{};
+    std::optional<std::array<GLenum, 2>> blend_func_{};
+    std::optional<GLenum> cull_face_{};
+    std::optional<std::array<GLint, 4>> viewport_{};
+
+    RenderStateCounters counters_{};
+    RenderStateCounters frame_counters_{};
+  };
+
+  // State shadow of the one context the demo renders with.
+  auto GetRenderState() -> RenderState&;
+
+}  // namespace brabbit
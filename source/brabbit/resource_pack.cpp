@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <brabbit/lz.hpp>
+#include <brabbit/parallel.hpp>
+#include <brabbit/resource_pack.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  Resource::Resource(std::span<const char> view) : view_{ view } {}
+
+  Resource::Resource(std::vector<char> buffer) : buffer_{ std::move(buffer) } {}
+
+  auto Resource::getData() const -> std::span<const char> {
+    return buffer_.empty() ? view_ : std::span<const char>{ buffer_ };
+  }
+
+  auto Resource::isEmpty() const -> bool {
+    return getData().empty();
+  }
+
+  ResourcePack::ResourcePack(const std::filesystem::path& path) {
+#if defined(_WIN32)
+    file_ = ::CreateFileW(path.c_str(),
+                          GENERIC_READ,
+                          FILE_SHARE_READ,
+                          nullptr,
+                          OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL,
+                          nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      file_ = nullptr;
+      return;
+    }
+
+    auto size = LARGE_INTEGER{};
+    if (!::GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+      release();
+      return;
+    }
+
+    mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data_ = mapping_ ? static_cast<const char*>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0))
+                     : nullptr;
+    size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+
+    // the mapping keeps the file referenced, the descriptor is not needed past mmap
+    struct stat status {};
+    if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+      auto* address = ::mmap(
+          nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address != MAP_FAILED) {
+        data_ = static_cast<const char*>(address);
+        size_ = static_cast<std::size_t>(status.st_size);
+      }
+    }
+    ::close(fd);
+#endif
+
+    if (!data_ || size_ < sizeof(PackHeader)) {
+      release();
+      return;
+    }
+
+    auto header = PackHeader{};
+    std::memcpy(&header, data_, sizeof(header));
+    const auto entries_size = std::size_t{ header.entry_count } * sizeof(PackEntry);
+    const auto entries_end = sizeof(PackHeader) + entries_size;
+    if (header.magic != PACK_MAGIC || header.version != PACK_VERSION || entries_end > size_ ||
+        header.names_offset > size_ || header.names_size > size_ - header.names_offset) {
+      release();
+      return;
+    }
+
+    const auto* entries = reinterpret_cast<const PackEntry*>(data_ + sizeof(PackHeader));
+    entries_ = { entries, header.entry_count };
+    names_ = { data_ + header.names_offset, static_cast<std::size_t>(header.names_size) };
+
+    // check every range once here, lookups and reads trust them afterwards
+    for (auto i = std::size_t{ 0 }; i < entries_.size(); ++i) {
+      const auto& entry = entries_[i];
+      const auto valid = entry.name_offset <= names_.size() &&
+                         entry.name_size <= names_.size() - entry.name_offset &&
+                         entry.offset <= size_ && entry.stored_size <= size_ - entry.offset &&
+                         (i == 0 || entries_[i - 1].hash <= entry.hash);
+      if (!valid) {
+        release();
+        return;
+      }
+    }
+  }
+
+  ResourcePack::~ResourcePack() {
+    release();
+  }
+
+  auto ResourcePack::release() -> void {
+#if defined(_WIN32)
+    if (data_) {
+      ::UnmapViewOfFile(data_);
+    }
+    if (mapping_) {
+      ::CloseHandle(mapping_);
+    }
+    if (file_) {
+      ::CloseHandle(file_);
+    }
+#else
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    entries_ = {};
+    names_ = {};
+    file_ = nullptr;
+    mapping_ = nullptr;
+  }
+
+  auto ResourcePack::isValid() const -> bool {
+    return data_ != nullptr;
+  }
+
+  auto ResourcePack::getEntries() const -> std::span<const PackEntry> {
+    return entries_;
+  }
+
+  auto ResourcePack::getName(const PackEntry& entry) const -> std::string_view {
+    return names_.substr(entry.name_offset, entry.name_size);
+  }
+
+  auto ResourcePack::find(std::string_view name) const -> const PackEntry* {
+    const auto hash = HashResourceName(name);
+    auto iter = std::lower_bound(
+        entries_.begin(), entries_.end(), hash, [](const PackEntry& entry, std::uint64_t value) {
+          return entry.hash < value;
+        });
+
+    for (; iter != entries_.end() && iter->hash == hash; ++iter) {
+      if (getName(*iter) == name) {
+        return &*iter;
+      }
+    }
+    return nullptr;
+  }
+
+  auto ResourcePack::read(const PackEntry& entry) const -> Resource {
+    const auto stored = std::span<const char>{ data_ + entry.offset, entry.stored_size };
+    switch (entry.compression) {
+      case PackCompression::NONE:
+        return Resource{ stored };
+
+      case PackCompression::LZ: {
+        auto buffer = std::vector<char>(entry.size);
+        if (!DecompressLz(stored, buffer)) {
+          return Resource{};
+        }
+        return Resource{ std::move(buffer) };
+      }
+    }
+    return Resource{};
+  }
+
+  auto GetResourcePack() -> const ResourcePack* {
+    static const auto Pack =
+        std::make_unique<ResourcePack>(GetResourceRoot().parent_path() / "resource.pack"sv);
+    return Pack->isValid() ? Pack.get() : nullptr;
+  }
+
+  auto LoadResource(std::string_view name) -> Resource {
+    if (const auto* pack = GetResourcePack(); pack) {
+      if (const auto* entry = pack->find(name); entry) {
+        return pack->read(*entry);
+      }
+    }
+
+    return Resource{ ReadFile(GetResourceRoot() / name) };
+  }
+
+  auto LoadResources(std::span<const std::string> names, const FileCallback& callback) -> void {
+    const auto* pack = GetResourcePack();
+
+    auto packed = std::vector<std::pair<std::size_t, const PackEntry*>>{};
+    auto missing = std::vector<std::size_t>{};
+    for (auto i = std::size_t{ 0 }; i < names.size(); ++i) {
+      const auto* entry = pack ? pack->find(names[i]) : nullptr;
+      if (entry) {
+        packed.emplace_back(i, entry);
+      } else {
+        missing.push_back(i);
+      }
+    }
+
+    ParallelFor(packed.size(), 1, [&](auto, auto begin, auto end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto resource = pack->read(*packed[i].second);
+        callback(packed[i].first, resource.getData());
+      }
+    });
+
+    if (missing.empty()) {
+      return;
+    }
+
+    auto paths = std::vector<std::filesystem::path>{};
+    paths.reserve(missing.size());
+    for (const auto index : missing) {
+      paths.push_back(GetResourceRoot() / names[index]);
+    }
+    ReadFiles(paths, [&](std::size_t index, std::span<const char> data) {
+      callback(missing[index], data);
+    });
+  }
+
+}  // namespace brabbit
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <brabbit/asset_io.hpp>
+#include <brabbit/pack_format.hpp>
+
+namespace brabbit {
+
+  // Contents of a resource, a view into a mapped pack or a buffer of its own.
+  class Resource {
+   public:
+    explicit Resource() = default;
+    explicit Resource(std::span<const char> view);
+    explicit Resource(std::vector<char> buffer);
+
+   public:
+    auto getData() const -> std::span<const char>;
+    auto isEmpty() const -> bool;
+
+   private:
+    std::span<const char> view_{};
+    std::vector<char> buffer_{};
+  };
+
+  // Read only view of a resource pack, mapped into memory for the lifetime of the object.
+  class ResourcePack {
+   public:
+    explicit ResourcePack(const std::filesystem::path& path);
+    virtual ~ResourcePack();
+
+    ResourcePack(const ResourcePack&) = delete;
+    auto operator=(const ResourcePack&) -> ResourcePack& = delete;
+
+   public:
+    auto isValid() const -> bool;
+
+    auto getEntries() const -> std::span<const PackEntry>;
+    auto getName(const PackEntry& entry) const -> std::string_view;
+
+    // Entry by name, nullptr when the pack does not hold it.
+    auto find(std::string_view name) const -> const PackEntry*;
+
+    // Uncompressed entries are served straight from the mapping, compressed ones are decoded into
+    // a buffer. Empty when the entry is damaged.
+    auto read(const PackEntry& entry) const -> Resource;
+
+   private:
+    auto release() -> void;
+
+   private:
+    const char* data_{ nullptr };
+    std::size_t size_{ 0 };
+    std::span<const PackEntry> entries_{};
+    std::string_view names_{};
+
+    void* file_{ nullptr };  // platform handles of the mapping
+    void* mapping_{ nullptr };
+  };
+
+  // resource.pack in the working directory, opened once. nullptr when there is none.
+  auto GetResourcePack() -> const ResourcePack*;
+
+  // Resource by its name below the resource directory, e.g. "model/cube.stl". Taken from the pack
+  // when it holds the name, read from the resource directory otherwise.
+  auto LoadResource(std::string_view name) -> Resource;
+
+  // Batch version of LoadResource, callback as for ReadFiles. Names missing from the pack are
+  // read from disk in a single batch.
+  auto LoadResources(std::span<const std::string> names, const FileCallback& callback) -> void;
+
+}  // namespace brabbit
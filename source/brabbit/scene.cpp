@@ -5,6 +5,9 @@
 #include <GLFW/glfw3.h>
 
 #include <brabbit/camera.hpp>
+#include <brabbit/frame_data.hpp>
+#include <brabbit/geometry_arena.hpp>
+#include <brabbit/instance_batcher.hpp>
 #include <brabbit/scene.hpp>
 #include <brabbit/window.hpp>
 
@@ -86,10 +89,16 @@ namespace brabbit {
     }
 
     object->scene_ = this;
+    bvh_dirty_ = true;
     return objects_.emplace_back(std::move(object)).get();
   }
 
   auto Scene::eraseObject(const SceneObject* object) -> void {
+    bvh_dirty_ = true;
+    if (hovered_.object == object) {
+      hovered_ = {};
+    }
+
     objects_.erase(
         std::remove_if(objects_.begin(), objects_.end(), GenerateContainsChecker(object)),
         objects_.end());
@@ -101,17 +110,59 @@ namespace brabbit {
       return nullptr;
     }
 
+    bvh_dirty_ = true;
+    if (hovered_.object == object) {
+      hovered_ = {};
+    }
+
     auto obj = std::move(*iter);
     objects_.erase(iter);
     return obj;
   }
 
   auto Scene::drawObjects() -> void {
+    if (!batcher_) {
+      batcher_ = std::make_unique<InstanceBatcher>();
+    }
+    batcher_->setDepthPrepass(depth_prepass_);
+
+    unbatched_.clear();
     for (const auto& object : objects_) {
       if (object) {
-        object->draw();
+        object->update();
+        if (!object->submit(*batcher_)) {
+          unbatched_.push_back(object.get());
+        }
       }
     }
+
+    // batched models are opaque and go first, translucent objects keep drawing last
+    batcher_->flush(camera_.get());
+    for (auto* object : unbatched_) {
+      object->draw();
+    }
+
+    // depth of the whole frame, for occlusion culling in the next one
+    if (camera_) {
+      batcher_->captureDepth(*camera_);
+    }
+
+    // the arena compacts itself a bounded amount per frame, after the frame's draws are issued
+    if (auto* arena = GetGeometryArena(); arena) {
+      arena->defragment();
+    }
+  }
+
+  auto Scene::isDepthPrepass() const -> bool {
+    return depth_prepass_;
+  }
+
+  auto Scene::setDepthPrepass(bool depth_prepass) -> void {
+    depth_prepass_ = depth_prepass;
+  }
+
+  auto Scene::getOverdrawFactor() const -> float {
+    return batcher_ ? batcher_->getOverdrawFactor() : 0.0f;
   }
 
   auto Scene::getCamera() const -> const Camera* {
@@ -130,6 +181,46 @@ namespace brabbit {
     return light_;
   }
 
+  auto Scene::pick(const Ray& ray) -> PickResult {
+    if (bvh_dirty_) {
+      updateBvh();
+    }
+
+    auto result = PickResult{};
+    bvh_.traverse(ray, result.distance, [this, &ray, &result](auto primitive, auto& max) {
+      const auto& entry = bvh_entries_[primitive];
+
+      // the direction is left unnormalized so distances stay in world units
+      const auto local = Ray{
+        glm::vec3{ entry.inverse_model * glm::vec4{ ray.origin, 1.0f } },
+        glm::vec3{ entry.inverse_model * glm::vec4{ ray.direction, 0.0f } },
+      };
+
+      auto hit = RayHit{ .distance = max };
+      if (!entry.object->intersect(local, hit)) {
+        return;
+      }
+
+      max = hit.distance;
+      result = {
+        .object = entry.object,
+        .triangle = hit.primitive,
+        .distance = hit.distance,
+        .position = ray.origin + ray.direction * hit.distance,
+      };
+    });
+
+    return result;
+  }
+
+  auto Scene::pick(const glm::vec2& screen_position) -> PickResult {
+    return pick(camera_->generateRay(screen_position));
+  }
+
+  auto Scene::getHovered() const -> const PickResult& {
+    return hovered_;
+  }
+
   auto Scene::processFrame(double delta_time) -> void {
     auto* handle = window_->getHandle();
     if (!handle) {
@@ -203,11 +294,76 @@ namespace brabbit {
       camera_->setFront(glm::normalize(front));
     }
 
+    // objects move while drawing, so world bounds are refreshed every frame
+    bvh_dirty_ = true;
+    updateHovered();
+
+    updateFrameData();
     drawObjects();
   }
 
+  auto Scene::updateFrameData() -> void {
+    if (!frame_data_) {
+      frame_data_ = std::make_unique<FrameDataBuffer>();
+    }
+
+    auto data = FrameData{};
+    if (camera_) {
+      data.view = camera_->getView();
+      data.projection = camera_->getProjection();
+      data.view_projection = data.projection * data.view;
+      data.camera_position = camera_->getPosition();
+    }
+    if (light_) {
+      data.light_color = light_->getColor();
+      data.light_position = light_->getPosition();
+      data.ambient_strength = light_->getAmbientStrength();
+      data.specular_strength = light_->getSpecularStrength();
+    }
+
+    frame_data_->update(data);
+  }
+
   auto Scene::updateScaleFactor() -> void {
     scale_factor_ = 1.0 / static_cast<double>(std::max({ width_, height_, depth_ }));
   }
 
+  auto Scene::updateBvh() -> void {
+    bvh_entries_.clear();
+
+    auto bounds = std::vector<Aabb>{};
+    for (const auto& object : objects_) {
+      if (!object) {
+        continue;
+      }
+
+      auto local_bounds = object->getBounds();
+      if (local_bounds.isEmpty()) {
+        continue;
+      }
+
+      const auto model = object->getScaledModel();
+      bounds.emplace_back(local_bounds.transform(model));
+      bvh_entries_.push_back({ object.get(), glm::inverse(model) });
+    }
+
+    bvh_ = Bvh{ bounds };
+    bvh_dirty_ = false;
+  }
+
+  auto Scene::updateHovered() -> void {
+    auto* handle = window_->getHandle();
+
+    // with a disabled (fps style) cursor the cursor is the center of the viewport
+    auto cursor = camera_->getSize() / 2.0f;
+    if (glfwGetInputMode(handle, GLFW_CURSOR) != GLFW_CURSOR_DISABLED) {
+      auto cursor_x = 0.0;
+      auto cursor_y = 0.0;
+      glfwGetCursorPos(handle, &cursor_x, &cursor_y);
+      cursor = { cursor_x, cursor_y };
+    }
+
+    hovered_ = pick(cursor);
+  }
+
 }  // namespace brabbit
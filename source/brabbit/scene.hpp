@@ -10,6 +10,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <brabbit/bvh.hpp>
 #include <brabbit/camera.hpp>
 #include <brabbit/shader.hpp>
 #include <brabbit/scene_object.hpp>
@@ -17,10 +18,19 @@
 
 namespace brabbit {
 
+  class FrameDataBuffer;
+  class InstanceBatcher;
   class Window;
   class SceneObject;
   class Light;
 
+  struct PickResult {
+    SceneObject*  object{ nullptr };
+    std::uint32_t triangle{ INVALID_INDEX };
+    float         distance{ std::numeric_limits<float>::infinity() };
+    glm::vec3     position{ 0.0f, 0.0f, 0.0f };
+  };
+
   class Scene {
     friend class Window;
 
@@ -64,6 +74,14 @@ namespace brabbit {
 
     auto drawObjects() -> void;
 
+    // Depth pre-pass of the batched models, off by default. Worth turning on when the overdraw
+    // factor stays well above 1 and fragment shading is what the frame waits for.
+    auto isDepthPrepass() const -> bool;
+    auto setDepthPrepass(bool depth_prepass) -> void;
+
+    // Samples shaded per visible sample of the batched models, 0 until measured.
+    auto getOverdrawFactor() const -> float;
+
    public:
     auto getCamera() const -> const Camera*;
     auto getCamera() -> Camera*;
@@ -71,11 +89,23 @@ namespace brabbit {
     auto getLight() const -> const Light*;
     auto getLight() -> Light*;
 
+   public:
+    // Closest object and triangle hit by a world space ray.
+    auto pick(const Ray& ray) -> PickResult;
+    // Pick through a viewport point of the camera, in pixels from the top left corner.
+    auto pick(const glm::vec2& screen_position) -> PickResult;
+
+    // Object under the cursor, updated every frame before drawing.
+    auto getHovered() const -> const PickResult&;
+
    protected:
     auto processFrame(double delta_time) -> void;
 
    private:
     auto updateScaleFactor() -> void;
+    auto updateBvh() -> void;
+    auto updateHovered() -> void;
+    auto updateFrameData() -> void;
 
    private:
     Window* window_{ nullptr };
@@ -89,7 +119,23 @@ namespace brabbit {
     std::unique_ptr<Camera> camera_{ nullptr };
 
     std::vector<std::unique_ptr<SceneObject>> objects_{};
+    std::vector<SceneObject*> unbatched_{};  // drawn one by one this frame, in scene order
+    std::unique_ptr<InstanceBatcher> batcher_{ nullptr };
+    bool depth_prepass_{ false };
+    std::unique_ptr<FrameDataBuffer> frame_data_{ nullptr };
     Light* light_{ nullptr };
+
+    struct BvhEntry {
+      SceneObject* object{ nullptr };
+      glm::mat4 inverse_model{ 1.0f };
+    };
+
+    // top level BVH over world bounds of pickable objects, rebuilt lazily
+    Bvh bvh_{};
+    std::vector<BvhEntry> bvh_entries_{};
+    bool bvh_dirty_{ true };
+
+    PickResult hovered_{};
   };
 
 }  // namespace brabbit
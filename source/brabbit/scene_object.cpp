@@ -43,6 +43,20 @@ namespace brabbit {
     return scene_;
   }
 
+  auto SceneObject::getBounds() const -> Aabb {
+    return {};
+  }
+
+  auto SceneObject::intersect(const Ray&, RayHit&) const -> bool {
+    return false;
+  }
+
+  auto SceneObject::update() -> void {}
+
+  auto SceneObject::submit(InstanceBatcher&) -> bool {
+    return false;
+  }
+
   auto SceneObject::draw() -> void {}
 
 }  // namespace brabbit
@@ -4,10 +4,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <brabbit/bvh.hpp>
 #include <brabbit/shader.hpp>
 
 namespace brabbit {
 
+  class InstanceBatcher;
   class Scene;
   class SceneObject {
     friend class Scene;
@@ -30,7 +32,21 @@ namespace brabbit {
     auto getScene() const -> const Scene*;
     auto getScene() -> Scene*;
 
+   public:
+    // Bounds in object space, an empty box keeps the object out of picking.
+    virtual auto getBounds() const -> Aabb;
+
+    // Closest hit of an object space ray, hit.primitive is object specific (triangle for models).
+    virtual auto intersect(const Ray& ray, RayHit& hit) const -> bool;
+
    protected:
+    // Per frame state, called for every object before anything is drawn.
+    virtual auto update() -> void;
+
+    // Hand the object to the batcher instead of drawing it, false when it draws itself. Objects
+    // that draw themselves may still add their per object data to it.
+    virtual auto submit(InstanceBatcher& batcher) -> bool;
+
     virtual auto draw() -> void;
 
    protected:
@@ -1,13 +1,19 @@
 #include "shader.hpp"
-#include <filesystem>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <brabbit/program_cache.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/resource_pack.hpp>
 #include <brabbit/shader.hpp>
+#include <brabbit/shader_compiler.hpp>
 
 namespace brabbit {
 
@@ -17,45 +23,55 @@ namespace brabbit {
   namespace {
 
     auto LoadShaderSource(std::string_view name) -> std::string {
-      auto path = std::filesystem::current_path() / "resource"sv / "shader"sv / name;
-      if (!std::filesystem::exists(path)) {
-        return {};
+      const auto resource = LoadResource("shader/"s.append(name));
+      return { resource.getData().begin(), resource.getData().end() };
+    }
+
+    // GLSL wants #version first, the defines go right after it and #line keeps error lines right
+    auto InsertDefines(std::string source, std::string_view defines) -> std::string {
+      if (defines.empty()) {
+        return source;
       }
 
-      auto file = std::ifstream{ path };
-      if (!file) {
-        return {};
+      const auto version = source.find("#version"sv);
+      if (version == std::string::npos) {
+        return source;
+      }
+      const auto end = source.find('\n', version);
+      if (end == std::string::npos) {
+        return source;
       }
 
-      return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+      const auto line = std::count(source.begin(), source.begin() + end, '\n') + 2;
+      auto prelude = std::string{ defines };
+      prelude.append("#line "sv).append(std::to_string(line)).push_back('\n');
+      source.insert(end + 1, prelude);
+      return source;
     }
 
   }  // namespace
 
-  Shader::Shader(std::string_view vertex_name, std::string_view fragment_name) {
-    id_ = glCreateProgram();
-
-    auto vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    auto vertex_shader_source = LoadShaderSource(vertex_name);
-    auto vertex_shader_source_cstr = vertex_shader_source.c_str();
-    glShaderSource(vertex_shader, 1, &vertex_shader_source_cstr, NULL);
-    glCompileShader(vertex_shader);
-    glAttachShader(id_, vertex_shader);
-
-    auto fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    auto fragment_shader_source = LoadShaderSource(fragment_name);
-    auto fragment_shader_source_cstr = fragment_shader_source.c_str();
-    glShaderSource(fragment_shader, 1, &fragment_shader_source_cstr, NULL);
-    glCompileShader(fragment_shader);
-    glAttachShader(id_, fragment_shader);
-
-    glLinkProgram(id_);
+  Shader::Shader(std::string_view vertex_name,
+                 std::string_view fragment_name,
+                 ShaderFeatures features,
+                 std::span<const std::string_view> feature_names)
+      : features_{ features } {
+    build({ { GL_VERTEX_SHADER, vertex_name }, { GL_FRAGMENT_SHADER, fragment_name } },
+          feature_names);
+  }
 
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
+  Shader::Shader(std::string_view compute_name,
+                 ShaderFeatures features,
+                 std::span<const std::string_view> feature_names)
+      : features_{ features } {
+    build({ { GL_COMPUTE_SHADER, compute_name } }, feature_names);
   }
 
   Shader::~Shader() {
+    for (const auto shader : shaders_) {
+      glDeleteShader(shader);
+    }
+    GetRenderState().forgetProgram(id_);
     glDeleteProgram(id_);
   }
 
@@ -63,72 +79,230 @@ namespace brabbit {
     return id_;
   }
 
+  auto Shader::getFeatures() const -> ShaderFeatures {
+    return features_;
+  }
+
+  auto Shader::isReady() -> bool {
+    if (ready_) {
+      return true;
+    }
+
+    // without the extension any query would wait, so the program counts as ready right away
+    if (HasParallelShaderCompile()) {
+      auto complete = GLint{ GL_FALSE };
+      glGetProgramiv(id_, GL_COMPLETION_STATUS_KHR, &complete);
+      if (complete == GL_FALSE) {
+        return false;
+      }
+    }
+
+    finish();
+    return true;
+  }
+
   auto Shader::use() -> void {
-    glUseProgram(id_);
+    if (!ready_) {
+      finish();
+    }
+    GetRenderState().useProgram(id_);
   }
 
-  auto Shader::getLocation(std::string_view name) const -> GLint {
-    return glGetUniformLocation(id_, name.data());
+  auto Shader::build(std::initializer_list<std::pair<GLenum, std::string_view>> stages,
+                     std::span<const std::string_view> feature_names) -> void {
+    id_ = glCreateProgram();
+
+    auto defines = std::string{};
+    for (auto i = std::size_t{ 0 }; i < feature_names.size(); ++i) {
+      if (features_ & (ShaderFeatures{ 1 } << i)) {
+        defines.append("#define "sv).append(feature_names[i]).append(" 1\n"sv);
+      }
+    }
+
+    // the defines are part of the sources, so every variant has its own binary cache entry
+    auto sources = std::vector<std::string>{};
+    for (const auto& [type, name] : stages) {
+      sources.push_back(InsertDefines(LoadShaderSource(name), defines));
+    }
+
+    // a warm start links the cached binary and never sees the GLSL compiler
+    if (LoadProgramBinary(id_, sources)) {
+      finish();
+      return;
+    }
+
+    auto source = sources.cbegin();
+    for (const auto& [type, name] : stages) {
+      auto shader = glCreateShader(type);
+      auto source_cstr = (source++)->c_str();
+      glShaderSource(shader, 1, &source_cstr, NULL);
+      glCompileShader(shader);
+      glAttachShader(id_, shader);
+      shaders_.push_back(shader);
+    }
+
+    // the link is queued behind the compiles, nothing here waits for either
+    glProgramParameteri(id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(id_);
+    sources_ = std::move(sources);
   }
 
-  auto Shader::setFloat(std::string_view name, GLfloat value) const -> void {
-    glUniform1f(getLocation(name), value);
+  auto Shader::finish() -> void {
+    if (!sources_.empty()) {
+      StoreProgramBinary(id_, sources_);
+      sources_.clear();
+    }
+    for (const auto shader : shaders_) {
+      glDeleteShader(shader);
+    }
+    shaders_.clear();
+
+    resolveUniforms();
+    ready_ = true;
   }
 
-  auto Shader::setInt(std::string_view name, GLint value) const -> void {
-    glUniform1i(getLocation(name), value);
+  auto Shader::resolveUniforms() -> void {
+    auto count = GLint{ 0 };
+    glGetProgramInterfaceiv(id_, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+    auto length = GLint{ 0 };
+    glGetProgramInterfaceiv(id_, GL_UNIFORM, GL_MAX_NAME_LENGTH, &length);
+    auto name = std::string(static_cast<std::size_t>(std::max(length, 1)), '\0');
+
+    uniforms_.clear();
+    for (auto index = GLuint{ 0 }; index < static_cast<GLuint>(count); ++index) {
+      // members of uniform blocks have no location, they are not set one by one
+      const auto property = GLenum{ GL_LOCATION };
+      auto location = GLint{ -1 };
+      glGetProgramResourceiv(id_, GL_UNIFORM, index, 1, &property, 1, nullptr, &location);
+      if (location < 0) {
+        continue;
+      }
+
+      auto written = GLsizei{ 0 };
+      glGetProgramResourceName(id_, GL_UNIFORM, index, length, &written, name.data());
+      auto view = std::string_view{ name.data(), static_cast<std::size_t>(written) };
+      if (view.ends_with("[0]"sv)) {
+        view.remove_suffix(3);
+      }
+
+      uniforms_.push_back(Uniform{ UniformName::Hash(view), location });
+    }
+
+    std::sort(uniforms_.begin(), uniforms_.end(), [](const auto& a, const auto& b) {
+      return a.hash < b.hash;
+    });
   }
 
-  auto Shader::setUint(std::string_view name, GLuint value) const -> void {
-    glUniform1ui(getLocation(name), value);
+  template <typename _Type>
+  auto Shader::change(UniformName name, const _Type& value) const -> GLint {
+    static_assert(sizeof(_Type) <= sizeof(Uniform::value), "uniform value too large");
+
+    const auto iter = std::lower_bound(
+        uniforms_.begin(), uniforms_.end(), name.hash, [](const auto& uniform, auto hash) {
+          return uniform.hash < hash;
+        });
+    if (iter == uniforms_.end() || iter->hash != name.hash) {
+      return -1;
+    }
+
+    if (iter->known && std::memcmp(iter->value.data(), &value, sizeof(_Type)) == 0) {
+      return -1;
+    }
+
+    std::memcpy(iter->value.data(), &value, sizeof(_Type));
+    iter->known = true;
+    return iter->location;
   }
 
-  auto Shader::setVec2(std::string_view name, const glm::vec2& value) const -> void {
-    glUniform2f(getLocation(name), value.x, value.y);
+  auto Shader::setFloat(UniformName name, GLfloat value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform1f(location, value);
+    }
   }
 
-  auto Shader::setVec3(std::string_view name, const glm::vec3& value) const -> void {
-    glUniform3f(getLocation(name), value.x, value.y, value.z);
+  auto Shader::setInt(UniformName name, GLint value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform1i(location, value);
+    }
   }
 
-  auto Shader::setVec4(std::string_view name, const glm::vec4& value) const -> void {
-    glUniform4f(getLocation(name), value.x, value.y, value.z, value.w);
+  auto Shader::setUint(UniformName name, GLuint value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform1ui(location, value);
+    }
   }
 
-  auto Shader::setIvec2(std::string_view name, const glm::ivec2& value) const -> void {
-    glUniform2i(getLocation(name), value.x, value.y);
+  auto Shader::setVec2(UniformName name, const glm::vec2& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform2f(location, value.x, value.y);
+    }
   }
 
-  auto Shader::setIvec3(std::string_view name, const glm::ivec3& value) const -> void {
-    glUniform3i(getLocation(name), value.x, value.y, value.z);
+  auto Shader::setVec3(UniformName name, const glm::vec3& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform3f(location, value.x, value.y, value.z);
+    }
   }
 
-  auto Shader::setIvec4(std::string_view name, const glm::ivec4& value) const -> void {
-    glUniform4i(getLocation(name), value.x, value.y, value.z, value.w);
+  auto Shader::setVec4(UniformName name, const glm::vec4& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform4f(location, value.x, value.y, value.z, value.w);
+    }
+  }
+
+  auto Shader::setIvec2(UniformName name, const glm::ivec2& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform2i(location, value.x, value.y);
+    }
+  }
+
+  auto Shader::setIvec3(UniformName name, const glm::ivec3& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform3i(location, value.x, value.y, value.z);
+    }
+  }
+
+  auto Shader::setIvec4(UniformName name, const glm::ivec4& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform4i(location, value.x, value.y, value.z, value.w);
+    }
   }
 
-  auto Shader::setUvec2(std::string_view name, const glm::uvec2& value) const -> void {
-    glUniform2ui(getLocation(name), value.x, value.y);
+  auto Shader::setUvec2(UniformName name, const glm::uvec2& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform2ui(location, value.x, value.y);
+    }
   }
 
-  auto Shader::setUvec3(std::string_view name, const glm::uvec3& value) const -> void {
-    glUniform3ui(getLocation(name), value.x, value.y, value.z);
+  auto Shader::setUvec3(UniformName name, const glm::uvec3& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform3ui(location, value.x, value.y, value.z);
+    }
   }
 
-  auto Shader::setUvec4(std::string_view name, const glm::uvec4& value) const -> void {
-    glUniform4ui(getLocation(name), value.x, value.y, value.z, value.w);
+  auto Shader::setUvec4(UniformName name, const glm::uvec4& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniform4ui(location, value.x, value.y, value.z, value.w);
+    }
   }
 
-  auto Shader::setMat2(std::string_view name, const glm::mat2& value) const -> void {
-    glUniformMatrix2fv(getLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+  auto Shader::setMat2(UniformName name, const glm::mat2& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    }
   }
 
-  auto Shader::setMat3(std::string_view name, const glm::mat3& value) const -> void {
-    glUniformMatrix3fv(getLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+  auto Shader::setMat3(UniformName name, const glm::mat3& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    }
   }
 
-  auto Shader::setMat4(std::string_view name, const glm::mat4& value) const -> void {
-    glUniformMatrix4fv(getLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+  auto Shader::setMat4(UniformName name, const glm::mat4& value) const -> void {
+    if (const auto location = change(name, value); location >= 0) {
+      glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    }
   }
 
 }  // namespace brabbit
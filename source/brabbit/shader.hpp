@@ -1,9 +1,13 @@
 #pragma once
 
-#include <map>
-#include <memory>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
 #include <string_view>
-#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -12,61 +16,106 @@
 
 namespace brabbit {
 
+  // Uniform name hashed at compile time, FNV-1a of the name without any array suffix.
+  struct UniformName {
+    consteval UniformName(std::string_view name) : hash{ Hash(name) } {}
+
+    static constexpr auto Hash(std::string_view name) -> std::uint64_t {
+      auto hash = std::uint64_t{ 14695981039346656037ull };
+      for (const auto character : name) {
+        hash = (hash ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+      }
+      return hash;
+    }
+
+    std::uint64_t hash{ 0 };
+  };
+
+  // Bit set of the #define switches a program is built with, bit i is the type's feature i.
+  using ShaderFeatures = std::uint32_t;
+
   class Shader {
    public:
     virtual ~Shader();
 
    public:
     auto getId() const -> GLuint;
+    auto getFeatures() const -> ShaderFeatures;
 
+    // Programs compile and link in the background where the driver can, false until this one is
+    // linked. Never waits, draws that find their program not ready skip the frame.
+    auto isReady() -> bool;
+
+    // Waits for the program if it is still being built.
     auto use() -> void;
 
    protected:
-    explicit Shader(std::string_view vertex_name, std::string_view fragment_name);
+    // Every stage is built with "#define <feature_names[i]> 1" for each bit i set in features.
+    explicit Shader(std::string_view vertex_name,
+                    std::string_view fragment_name,
+                    ShaderFeatures features = 0,
+                    std::span<const std::string_view> feature_names = {});
+
+    // Compute program.
+    explicit Shader(std::string_view compute_name,
+                    ShaderFeatures features = 0,
+                    std::span<const std::string_view> feature_names = {});
 
    protected:
-    auto setFloat(std::string_view name, GLfloat value) const -> void;
-    auto setInt(std::string_view name, GLint value) const -> void;
-    auto setUint(std::string_view name, GLuint value) const -> void;
+    // Uniforms are looked up by hash in a table filled after linking, and a value equal to the
+    // one set last is not sent again. Unknown or inactive names are ignored.
+    auto setFloat(UniformName name, GLfloat value) const -> void;
+    auto setInt(UniformName name, GLint value) const -> void;
+    auto setUint(UniformName name, GLuint value) const -> void;
 
-    auto setVec2(std::string_view name, const glm::vec2& value) const -> void;
-    auto setVec3(std::string_view name, const glm::vec3& value) const -> void;
-    auto setVec4(std::string_view name, const glm::vec4& value) const -> void;
+    auto setVec2(UniformName name, const glm::vec2& value) const -> void;
+    auto setVec3(UniformName name, const glm::vec3& value) const -> void;
+    auto setVec4(UniformName name, const glm::vec4& value) const -> void;
 
-    auto setIvec2(std::string_view name, const glm::ivec2& value) const -> void;
-    auto setIvec3(std::string_view name, const glm::ivec3& value) const -> void;
-    auto setIvec4(std::string_view name, const glm::ivec4& value) const -> void;
+    auto setIvec2(UniformName name, const glm::ivec2& value) const -> void;
+    auto setIvec3(UniformName name, const glm::ivec3& value) const -> void;
+    auto setIvec4(UniformName name, const glm::ivec4& value) const -> void;
 
-    auto setUvec2(std::string_view name, const glm::uvec2& value) const -> void;
-    auto setUvec3(std::string_view name, const glm::uvec3& value) const -> void;
-    auto setUvec4(std::string_view name, const glm::uvec4& value) const -> void;
+    auto setUvec2(UniformName name, const glm::uvec2& value) const -> void;
+    auto setUvec3(UniformName name, const glm::uvec3& value) const -> void;
+    auto setUvec4(UniformName name, const glm::uvec4& value) const -> void;
 
-    auto setMat2(std::string_view name, const glm::mat2& value) const -> void;
-    auto setMat3(std::string_view name, const glm::mat3& value) const -> void;
-    auto setMat4(std::string_view name, const glm::mat4& value) const -> void;
+    auto setMat2(UniformName name, const glm::mat2& value) const -> void;
+    auto setMat3(UniformName name, const glm::mat3& value) const -> void;
+    auto setMat4(UniformName name, const glm::mat4& value) const -> void;
 
    private:
-    auto getLocation(std::string_view name) const -> GLint;
+    struct Uniform {
+      std::uint64_t hash{ 0 };
+      GLint location{ -1 };
+      bool known{ false };  // value holds what the program has
+      std::array<unsigned char, sizeof(glm::mat4)> value{};
+    };
 
    private:
-    GLuint id_{ 0 };
-  };
+    // Link the program from a cached binary when there is a valid one, else start compiling and
+    // linking it from source.
+    auto build(std::initializer_list<std::pair<GLenum, std::string_view>> stages,
+               std::span<const std::string_view> feature_names) -> void;
 
-  template <typename _Type>
-  auto LoadCachedShader() -> _Type* {
-    static_assert(std::is_base_of_v<Shader, _Type>, "_Type must be derived from Shader");
+    // Everything that needs the linked program, once it is linked.
+    auto finish() -> void;
 
-    const char* type = typeid(_Type).name();
+    // Location table of the linked program, sorted by hash.
+    auto resolveUniforms() -> void;
 
-    static std::map<const char*, std::unique_ptr<Shader>> Cache;
-    if (auto iter = Cache.find(type); iter != Cache.cend()) {
-      return static_cast<_Type*>(iter->second.get());
-    }
+    // Location to send value to, -1 when the name is unknown or the program has it already.
+    template <typename _Type>
+    auto change(UniformName name, const _Type& value) const -> GLint;
 
-    auto base = std::make_unique<_Type>();
-    auto* derived = static_cast<_Type*>(base.get());
-    Cache.emplace(type, std::move(base));
-    return derived;
-  }
+   private:
+    GLuint id_{ 0 };
+    ShaderFeatures features_{ 0 };
+    mutable std::vector<Uniform> uniforms_{};
+
+    bool ready_{ false };
+    std::vector<GLuint> shaders_{};       // attached until the link is done
+    std::vector<std::string> sources_{};  // cache key of a program built from source
+  };
 
 }  // namespace brabbit
@@ -0,0 +1,70 @@
+#include <string_view>
+
+#include <glad/glad.h>
+
+#include <brabbit/cull_shader.hpp>
+#include <brabbit/depth_pyramid_shader.hpp>
+#include <brabbit/flat_shader.hpp>
+#include <brabbit/phong_shader.hpp>
+#include <brabbit/shader_compiler.hpp>
+#include <brabbit/shader_registry.hpp>
+
+namespace brabbit {
+
+  using namespace std::string_view_literals;
+
+  namespace {
+
+    using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+    constexpr auto DRIVER_THREAD_COUNT = GLuint{ 0xffffffff };  // leave it to the driver
+
+    auto ParallelShaderCompile() -> bool& {
+      static auto State = false;
+      return State;
+    }
+
+    auto HasExtension(std::string_view name) -> bool {
+      auto count = GLint{ 0 };
+      glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+      for (auto i = GLint{ 0 }; i < count; ++i) {
+        const auto* extension =
+            reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && name == extension) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+  }  // namespace
+
+  auto LoadParallelShaderCompile(GLADloadproc load) -> bool {
+    auto* max_threads = static_cast<MaxShaderCompilerThreadsProc>(nullptr);
+    if (HasExtension("GL_KHR_parallel_shader_compile"sv)) {
+      max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+          load("glMaxShaderCompilerThreadsKHR"));
+    } else if (HasExtension("GL_ARB_parallel_shader_compile"sv)) {
+      max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+          load("glMaxShaderCompilerThreadsARB"));
+    }
+
+    ParallelShaderCompile() = max_threads != nullptr;
+    if (max_threads) {
+      max_threads(DRIVER_THREAD_COUNT);
+    }
+    return ParallelShaderCompile();
+  }
+
+  auto HasParallelShaderCompile() -> bool {
+    return ParallelShaderCompile();
+  }
+
+  auto PreloadShaders() -> void {
+    LoadCachedShader<PhongShader>(PhongShader::AMBIENT_LIGHT);
+    LoadCachedShader<FlatShader>();
+    LoadCachedShader<CullShader>();
+    LoadCachedShader<DepthPyramidShader>();
+  }
+
+}  // namespace brabbit
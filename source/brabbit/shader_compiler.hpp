@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace brabbit {
+
+  // GL_KHR_parallel_shader_compile, or its ARB twin, which glad was generated without. With it the
+  // driver compiles and links on its own threads and GL_COMPLETION_STATUS_KHR tells whether a
+  // shader or program is done without waiting for it.
+  constexpr auto GL_MAX_SHADER_COMPILER_THREADS_KHR = GLenum{ 0x91B0 };
+  constexpr auto GL_COMPLETION_STATUS_KHR = GLenum{ 0x91B1 };
+
+  // Look for the extension in the current context and let the driver pick its thread count,
+  // false when it is not there. Call once after glad is loaded, with the same loader.
+  auto LoadParallelShaderCompile(GLADloadproc load) -> bool;
+
+  auto HasParallelShaderCompile() -> bool;
+
+  // Create every program the renderer starts with, so they all compile at once instead of each
+  // one stalling the frame that first needs it. Other variants are built on first use.
+  auto PreloadShaders() -> void;
+
+}  // namespace brabbit
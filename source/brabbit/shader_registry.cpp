@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <brabbit/shader_registry.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    // Sorted by program and features, never changed once published.
+    struct ShaderSnapshot {
+      std::vector<ShaderVariant*> variants{};
+    };
+
+    class ShaderRegistry {
+     public:
+      auto find(const void* program, ShaderFeatures features, ShaderVariant::Factory factory)
+          -> ShaderVariant& {
+        if (auto* variant = search(snapshot_.load(std::memory_order_acquire), program, features);
+            variant) {
+          return *variant;
+        }
+
+        auto lock = std::lock_guard{ mutex_ };
+        const auto* current = snapshot_.load(std::memory_order_relaxed);
+        if (auto* variant = search(current, program, features); variant) {
+          return *variant;
+        }
+
+        auto& variant = *variants_.emplace_back(
+            std::make_unique<ShaderVariant>(program, features, factory));
+
+        // readers may still hold the old snapshot, it is kept until exit, there are only a few
+        auto next = current ? std::make_unique<ShaderSnapshot>(*current)
+                            : std::make_unique<ShaderSnapshot>();
+        next->variants.insert(
+            std::upper_bound(next->variants.begin(), next->variants.end(), &variant, Less),
+            &variant);
+        snapshot_.store(snapshots_.emplace_back(std::move(next)).get(),
+                        std::memory_order_release);
+        return variant;
+      }
+
+     private:
+      // addresses of unrelated objects only have a total order as integers
+      static auto Key(const void* program, ShaderFeatures features) {
+        return std::tuple{ reinterpret_cast<std::uintptr_t>(program), features };
+      }
+
+      static auto Key(const ShaderVariant* variant) {
+        return Key(variant->getProgram(), variant->getFeatures());
+      }
+
+      static auto Less(const ShaderVariant* lhs, const ShaderVariant* rhs) -> bool {
+        return Key(lhs) < Key(rhs);
+      }
+
+      static auto search(const ShaderSnapshot* snapshot,
+                         const void* program,
+                         ShaderFeatures features) -> ShaderVariant* {
+        if (!snapshot) {
+          return nullptr;
+        }
+
+        const auto key = Key(program, features);
+        const auto iter = std::lower_bound(
+            snapshot->variants.begin(),
+            snapshot->variants.end(),
+            key,
+            [](const ShaderVariant* variant, const auto& key) { return Key(variant) < key; });
+        return iter != snapshot->variants.end() && Key(*iter) == key ? *iter : nullptr;
+      }
+
+     private:
+      std::mutex mutex_{};
+      std::vector<std::unique_ptr<ShaderVariant>> variants_{};
+      std::vector<std::unique_ptr<ShaderSnapshot>> snapshots_{};
+      std::atomic<const ShaderSnapshot*> snapshot_{ nullptr };
+    };
+
+    auto GetShaderRegistry() -> ShaderRegistry& {
+      static auto Registry = ShaderRegistry{};
+      return Registry;
+    }
+
+  }  // namespace
+
+  ShaderVariant::ShaderVariant(const void* program, ShaderFeatures features, Factory factory)
+      : program_{ program }, features_{ features }, factory_{ factory } {}
+
+  ShaderVariant::~ShaderVariant() {}
+
+  auto ShaderVariant::getProgram() const -> const void* {
+    return program_;
+  }
+
+  auto ShaderVariant::getFeatures() const -> ShaderFeatures {
+    return features_;
+  }
+
+  auto ShaderVariant::peek() const -> Shader* {
+    return published_.load(std::memory_order_acquire);
+  }
+
+  auto ShaderVariant::get() -> Shader* {
+    if (!shader_ && factory_) {
+      shader_ = factory_(features_);
+      factory_ = nullptr;  // a type without the features stays empty
+      published_.store(shader_.get(), std::memory_order_release);
+    }
+    return shader_.get();
+  }
+
+  auto FindShaderVariant(const void* program,
+                         ShaderFeatures features,
+                         ShaderVariant::Factory factory) -> ShaderVariant& {
+    return GetShaderRegistry().find(program, features, factory);
+  }
+
+}  // namespace brabbit
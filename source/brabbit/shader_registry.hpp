@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#include <brabbit/shader.hpp>
+
+namespace brabbit {
+
+  // One program of the registry: a shader type with a set of features. Variants are created
+  // empty, the program is built the first time the render thread asks for it.
+  class ShaderVariant {
+   public:
+    using Factory = auto (*)(ShaderFeatures features) -> std::unique_ptr<Shader>;
+
+    explicit ShaderVariant(const void* program, ShaderFeatures features, Factory factory);
+    virtual ~ShaderVariant();
+
+    ShaderVariant(const ShaderVariant&) = delete;
+    auto operator=(const ShaderVariant&) -> ShaderVariant& = delete;
+
+   public:
+    auto getProgram() const -> const void*;
+    auto getFeatures() const -> ShaderFeatures;
+
+    // Any thread, nullptr until the render thread built the program.
+    auto peek() const -> Shader*;
+
+    // Render thread only, starts building the program on the first call.
+    auto get() -> Shader*;
+
+   private:
+    const void* program_{ nullptr };
+    ShaderFeatures features_{ 0 };
+    Factory factory_{ nullptr };
+
+    std::unique_ptr<Shader> shader_{ nullptr };
+    std::atomic<Shader*> published_{ nullptr };
+  };
+
+  // Variant of program, one address per shader type, with features, added on the first lookup.
+  // Lookups of known variants read an immutable snapshot of the registry and never lock, only
+  // adding a variant does, so loader threads can look up while the render thread draws.
+  auto FindShaderVariant(const void* program,
+                         ShaderFeatures features,
+                         ShaderVariant::Factory factory) -> ShaderVariant&;
+
+  // Address identifying a shader type in the registry.
+  template <typename _Type>
+  inline constexpr char SHADER_PROGRAM_TAG = 0;
+
+  template <typename _Type>
+  auto GetShaderVariant(ShaderFeatures features = 0) -> ShaderVariant& {
+    static_assert(std::is_base_of_v<Shader, _Type>, "_Type must be derived from Shader");
+
+    constexpr auto factory = [](ShaderFeatures features) -> std::unique_ptr<Shader> {
+      if constexpr (std::is_constructible_v<_Type, ShaderFeatures>) {
+        return std::make_unique<_Type>(features);
+      } else {
+        return features == 0 ? std::make_unique<_Type>() : nullptr;
+      }
+    };
+    return FindShaderVariant(&SHADER_PROGRAM_TAG<_Type>, features, factory);
+  }
+
+  // Render thread only, nullptr for features the type does not have.
+  template <typename _Type>
+  auto LoadCachedShader(ShaderFeatures features = 0) -> _Type* {
+    return static_cast<_Type*>(GetShaderVariant<_Type>(features).get());
+  }
+
+}  // namespace brabbit
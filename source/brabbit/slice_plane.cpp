@@ -0,0 +1,148 @@
+#include <brabbit/flat_shader.hpp>
+#include <brabbit/render_state.hpp>
+#include <brabbit/scene.hpp>
+#include <brabbit/shader_registry.hpp>
+#include <brabbit/slice_plane.hpp>
+#include <brabbit/vertex_layout.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto PLANE_VERTEX_COUNT = 6;
+    constexpr auto PLANE_MARGIN = 0.05f;  // relative to the model size
+
+    using PlaneLayout = VertexLayout<VertexAttribute<0, glm::vec3>>;
+
+  }  // namespace
+
+  SlicePlane::SlicePlane(const Model* model, float layer_height) : model_{ model } {
+    if (!model_ || !model_->getMesh()) {
+      return;
+    }
+
+    shader_ = LoadCachedShader<FlatShader>();
+    layers_ = SliceMesh(*model_->getMesh(), layer_height);
+
+    glCreateVertexArrays(1, &vao_);
+    PlaneLayout::Apply(vao_);
+
+    // plane and contour vertices share one buffer, rewritten when the layer changes
+    glCreateBuffers(1, &vbo_);
+    PlaneLayout::BindBuffer(vao_, 0, vbo_);
+
+    updateBuffer();
+  }
+
+  SlicePlane::~SlicePlane() {
+    auto& state = GetRenderState();
+    state.forgetBuffer(vbo_);
+    state.forgetVertexArray(vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteVertexArrays(1, &vao_);
+  }
+
+  auto SlicePlane::getLayers() const -> const std::vector<SliceLayer>& {
+    return layers_;
+  }
+
+  auto SlicePlane::getLayerIndex() const -> std::size_t {
+    return layer_index_;
+  }
+
+  auto SlicePlane::setLayerIndex(std::size_t index) -> void {
+    if (layers_.empty()) {
+      return;
+    }
+
+    layer_index_ = std::min(index, layers_.size() - 1);
+    updateBuffer();
+  }
+
+  auto SlicePlane::getPlaneColor() const -> const glm::vec4& {
+    return plane_color_;
+  }
+
+  auto SlicePlane::setPlaneColor(const glm::vec4& color) -> void {
+    plane_color_ = color;
+  }
+
+  auto SlicePlane::getContourColor() const -> const glm::vec4& {
+    return contour_color_;
+  }
+
+  auto SlicePlane::setContourColor(const glm::vec4& color) -> void {
+    contour_color_ = color;
+  }
+
+  auto SlicePlane::draw() -> void {
+    if (layers_.empty()) {
+      return;
+    }
+
+    auto* shader = static_cast<FlatShader*>(shader_);
+    if (!shader || !shader->isReady()) {
+      return;
+    }
+
+    shader->use();
+    shader->setModel(model_->getScaledModel());
+
+    auto& state = GetRenderState();
+    state.bindVertexArray(vao_);
+
+    shader->setLightColor(contour_color_);
+    glDrawArrays(GL_LINES, PLANE_VERTEX_COUNT, contour_vertex_count_);
+
+    // translucent plane last, without hiding what is behind it from later depth tests
+    state.setEnabled(GL_BLEND, true);
+    state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.setDepthMask(false);
+
+    shader->setLightColor(plane_color_);
+    glDrawArrays(GL_TRIANGLES, 0, PLANE_VERTEX_COUNT);
+
+    state.setDepthMask(true);
+    state.setEnabled(GL_BLEND, false);
+  }
+
+  auto SlicePlane::updateBuffer() -> void {
+    if (layers_.empty()) {
+      return;
+    }
+
+    const auto& layer = layers_[layer_index_];
+    const auto bounds = model_->getMesh()->getBounds();
+    const auto margin = glm::vec3{ bounds.getExtent() * PLANE_MARGIN };
+    const auto low = bounds.min - margin;
+    const auto high = bounds.max + margin;
+    const auto z = layer.z;
+
+    auto vertices = std::vector<glm::vec3>{
+      { low.x, low.y, z },   { high.x, low.y, z },  { high.x, high.y, z },
+      { low.x, low.y, z },   { high.x, high.y, z }, { low.x, high.y, z },
+    };
+
+    for (const auto& contour : layer.contours) {
+      const auto& points = contour.points;
+      for (auto i = std::size_t{ 1 }; i < points.size(); ++i) {
+        vertices.push_back(points[i - 1]);
+        vertices.push_back(points[i]);
+      }
+
+      if (contour.closed && points.size() > 2) {
+        vertices.push_back(points.back());
+        vertices.push_back(points.front());
+      }
+    }
+
+    contour_vertex_count_ = static_cast<GLsizei>(vertices.size() - PLANE_VERTEX_COUNT);
+
+    GetRenderState().bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER,
+                 vertices.size() * sizeof(glm::vec3),
+                 glm::value_ptr(vertices.front()),
+                 GL_DYNAMIC_DRAW);
+  }
+
+}  // namespace brabbit
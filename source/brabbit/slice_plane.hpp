@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/model.hpp>
+#include <brabbit/scene_object.hpp>
+#include <brabbit/slicer.hpp>
+
+namespace brabbit {
+
+  // Slices a model into layers and draws the current layer: a translucent plane across the
+  // model's bounds and the layer's contours, following the model's placement.
+  class SlicePlane : public SceneObject {
+   public:
+    explicit SlicePlane(const Model* model, float layer_height);
+    virtual ~SlicePlane() override;
+
+   public:
+    auto getLayers() const -> const std::vector<SliceLayer>&;
+
+    auto getLayerIndex() const -> std::size_t;
+    auto setLayerIndex(std::size_t index) -> void;
+
+    auto getPlaneColor() const -> const glm::vec4&;
+    auto setPlaneColor(const glm::vec4& color) -> void;
+
+    auto getContourColor() const -> const glm::vec4&;
+    auto setContourColor(const glm::vec4& color) -> void;
+
+   protected:
+    auto draw() -> void override;
+
+   private:
+    auto updateBuffer() -> void;
+
+   private:
+    const Model* model_{ nullptr };
+    std::vector<SliceLayer> layers_{};
+    std::size_t layer_index_{ 0 };
+
+    glm::vec4 plane_color_{ 0.2f, 0.6f, 1.0f, 0.3f };
+    glm::vec4 contour_color_{ 1.0f, 0.2f, 0.2f, 1.0f };
+
+    unsigned int vbo_{ 0 };
+    GLsizei contour_vertex_count_{ 0 };
+  };
+
+}  // namespace brabbit
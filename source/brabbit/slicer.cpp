@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <brabbit/parallel.hpp>
+#include <brabbit/slicer.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto GRAIN = std::size_t{ 4096 };
+
+    struct Segment {
+      glm::vec3 from{};
+      glm::vec3 to{};
+    };
+
+    // Points are compared bit exact, IntersectEdge makes shared edges produce identical points.
+    auto GetKey(const glm::vec3& point) -> std::uint64_t {
+      return static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(point.x)) << 32 |
+             std::bit_cast<std::uint32_t>(point.y);
+    }
+
+    auto IntersectEdge(glm::vec3 a, glm::vec3 b, float z) -> glm::vec3 {
+      // interpolate in a fixed endpoint order, whichever triangle the edge belongs to
+      if (std::tie(b.x, b.y, b.z) < std::tie(a.x, a.y, a.z)) {
+        std::swap(a, b);
+      }
+
+      const auto t = (z - a.z) / (b.z - a.z);
+      return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, z };
+    }
+
+    auto IntersectTriangle(const glm::vec3& a,
+                           const glm::vec3& b,
+                           const glm::vec3& c,
+                           float z,
+                           Segment& segment) -> bool {
+      // vertices on the plane count as above, so every crossing edge has one strict side
+      const auto vertices = std::array{ a, b, c };
+      const auto above = std::array{ a.z >= z, b.z >= z, c.z >= z };
+      if (above[0] == above[1] && above[1] == above[2]) {
+        return false;
+      }
+
+      // the lone vertex on its side owns both crossing edges
+      const auto lone = above[0] == above[1] ? 2 : (above[0] == above[2] ? 1 : 0);
+      const auto& tip = vertices[lone];
+      segment.from = IntersectEdge(tip, vertices[(lone + 1) % 3], z);
+      segment.to = IntersectEdge(tip, vertices[(lone + 2) % 3], z);
+      if (GetKey(segment.from) == GetKey(segment.to)) {
+        return false;
+      }
+
+      // outward normal on the right of the segment: counter clockwise outer loops seen from +Z
+      const auto normal = glm::cross(b - a, c - a);
+      const auto direction = segment.to - segment.from;
+      if (direction.y * normal.x - direction.x * normal.y < 0.0f) {
+        std::swap(segment.from, segment.to);
+      }
+
+      return true;
+    }
+
+    auto ChainSegments(const std::vector<Segment>& segments) -> std::vector<Contour> {
+      auto starts = std::unordered_map<std::uint64_t, std::uint32_t>{};
+      auto ends = std::unordered_set<std::uint64_t>{};
+      starts.reserve(segments.size());
+      ends.reserve(segments.size());
+      for (auto i = std::uint32_t{ 0 }; i < segments.size(); ++i) {
+        starts.emplace(GetKey(segments[i].from), i);
+        ends.emplace(GetKey(segments[i].to));
+      }
+
+      auto contours = std::vector<Contour>{};
+      auto visited = std::vector<bool>(segments.size(), false);
+      const auto walk = [&](std::uint32_t first) {
+        auto& contour = contours.emplace_back();
+        const auto first_key = GetKey(segments[first].from);
+
+        auto current = first;
+        while (true) {
+          visited[current] = true;
+          contour.points.push_back(segments[current].from);
+
+          const auto key = GetKey(segments[current].to);
+          if (key == first_key) {
+            contour.closed = true;
+            return;
+          }
+
+          const auto next = starts.find(key);
+          if (next == starts.end() || visited[next->second]) {
+            contour.points.push_back(segments[current].to);
+            return;
+          }
+          current = next->second;
+        }
+      };
+
+      // open chains (holes in the mesh) first, from their heads, then the closed loops
+      for (auto i = std::uint32_t{ 0 }; i < segments.size(); ++i) {
+        if (!visited[i] && !ends.contains(GetKey(segments[i].from))) {
+          walk(i);
+        }
+      }
+      for (auto i = std::uint32_t{ 0 }; i < segments.size(); ++i) {
+        if (!visited[i]) {
+          walk(i);
+        }
+      }
+
+      return contours;
+    }
+
+  }  // namespace
+
+  auto SliceMesh(const Mesh& mesh, float layer_height) -> std::vector<SliceLayer> {
+    const auto& vertices = mesh.getVertices();
+    if (vertices.empty() || layer_height <= 0.0f) {
+      return {};
+    }
+
+    const auto bounds = mesh.getBounds();
+    const auto count = static_cast<std::size_t>(
+        std::max(1.0f, std::ceil((bounds.max.z - bounds.min.z) / layer_height)));
+
+    auto heights = std::vector<float>(count);
+    for (auto i = std::size_t{ 0 }; i < count; ++i) {
+      heights[i] = bounds.min.z + (static_cast<float>(i) + 0.5f) * layer_height;
+    }
+
+    return SliceMesh(mesh, heights);
+  }
+
+  auto SliceMesh(const Mesh& mesh, const std::vector<float>& heights) -> std::vector<SliceLayer> {
+    const auto& vertices = mesh.getVertices();
+    const auto& indices = mesh.getIndices();
+    const auto layer_count = heights.size();
+    if (indices.empty() || heights.empty()) {
+      return {};
+    }
+
+    // Bucket triangles by the layers their Z interval spans, as one flat array grouped by layer.
+    // Chunks count into their own row so the fill pass below can write without atomics.
+    const auto chunks = GetParallelChunkCount(indices.size(), GRAIN);
+    auto spans = std::vector<std::pair<std::uint32_t, std::uint32_t>>(indices.size());
+    auto counts = std::vector<std::size_t>(chunks * layer_count, 0);
+
+    ParallelFor(indices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+      auto* row = counts.data() + chunk * layer_count;
+      for (auto i = begin; i < end; ++i) {
+        const auto& triangle = indices[i];
+        const auto low = std::min({ vertices[triangle.x].z, vertices[triangle.y].z,
+                                    vertices[triangle.z].z });
+        const auto high = std::max({ vertices[triangle.x].z, vertices[triangle.y].z,
+                                     vertices[triangle.z].z });
+        const auto first = std::lower_bound(heights.begin(), heights.end(), low) - heights.begin();
+        const auto last = std::upper_bound(heights.begin(), heights.end(), high) - heights.begin();
+
+        spans[i] = { static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(last) };
+        for (auto layer = first; layer < last; ++layer) {
+          ++row[layer];
+        }
+      }
+    });
+
+    auto layer_offsets = std::vector<std::size_t>(layer_count + 1, 0);
+    auto offsets = std::vector<std::size_t>(chunks * layer_count, 0);
+    auto total = std::size_t{ 0 };
+    for (auto layer = std::size_t{ 0 }; layer < layer_count; ++layer) {
+      layer_offsets[layer] = total;
+      for (auto chunk = std::size_t{ 0 }; chunk < chunks; ++chunk) {
+        offsets[chunk * layer_count + layer] = total;
+        total += counts[chunk * layer_count + layer];
+      }
+    }
+    layer_offsets[layer_count] = total;
+
+    auto buckets = std::vector<std::uint32_t>(total);
+    ParallelFor(indices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+      auto* row = offsets.data() + chunk * layer_count;
+      for (auto i = begin; i < end; ++i) {
+        for (auto layer = spans[i].first; layer < spans[i].second; ++layer) {
+          buckets[row[layer]++] = static_cast<std::uint32_t>(i);
+        }
+      }
+    });
+
+    // every layer is independent from here
+    auto layers = std::vector<SliceLayer>(layer_count);
+    ParallelFor(layer_count, 1, [&](auto, auto begin, auto end) {
+      auto segments = std::vector<Segment>{};
+      for (auto layer = begin; layer < end; ++layer) {
+        const auto z = heights[layer];
+
+        segments.clear();
+        for (auto i = layer_offsets[layer]; i < layer_offsets[layer + 1]; ++i) {
+          const auto& triangle = indices[buckets[i]];
+          auto segment = Segment{};
+          if (IntersectTriangle(vertices[triangle.x],
+                                vertices[triangle.y],
+                                vertices[triangle.z],
+                                z,
+                                segment)) {
+            segments.push_back(segment);
+          }
+        }
+
+        layers[layer] = { z, ChainSegments(segments) };
+      }
+    });
+
+    return layers;
+  }
+
+}  // namespace brabbit
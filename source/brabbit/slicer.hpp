@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/mesh.hpp>
+
+namespace brabbit {
+
+  struct Contour {
+    std::vector<glm::vec3> points{};
+    bool closed{ false };  // closed loops do not repeat the first point at the end
+  };
+
+  struct SliceLayer {
+    float z{ 0.0f };
+    std::vector<Contour> contours{};
+  };
+
+  // Cross sections of a mesh with planes perpendicular to its Z axis.
+  // Layers sit in the middle of each layer_height interval, starting from the bottom of the mesh.
+  // Closed meshes give closed loops, outer loops counter clockwise when viewed from +Z.
+  auto SliceMesh(const Mesh& mesh, float layer_height) -> std::vector<SliceLayer>;
+
+  // Cross sections at arbitrary heights, heights must be sorted in ascending order.
+  auto SliceMesh(const Mesh& mesh, const std::vector<float>& heights) -> std::vector<SliceLayer>;
+
+}  // namespace brabbit
@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include <brabbit/render_state.hpp>
+#include <brabbit/upload_ring.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto WAIT_TIMEOUT = GLuint64{ 1'000'000 };  // ns
+
+    auto CurrentRing() -> UploadRing*& {
+      static auto Ring = static_cast<UploadRing*>(nullptr);
+      return Ring;
+    }
+
+  }  // namespace
+
+  UploadRing::UploadRing(std::size_t frame_size) : frame_size_{ frame_size } {
+    constexpr auto FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    const auto size = static_cast<GLsizeiptr>(frame_size_ * FRAMES_IN_FLIGHT);
+    glCreateBuffers(1, &buffer_);
+    glNamedBufferStorage(buffer_, size, nullptr, FLAGS);
+    data_ = static_cast<char*>(glMapNamedBufferRange(buffer_, 0, size, FLAGS));
+
+    CurrentRing() = this;
+  }
+
+  UploadRing::~UploadRing() {
+    if (CurrentRing() == this) {
+      CurrentRing() = nullptr;
+    }
+
+    for (auto& frame : frames_) {
+      glDeleteSync(static_cast<GLsync>(frame.fence));
+    }
+    if (data_) {
+      glUnmapNamedBuffer(buffer_);
+    }
+    GetRenderState().forgetBuffer(buffer_);
+    glDeleteBuffers(1, &buffer_);
+  }
+
+  auto UploadRing::isValid() const -> bool {
+    return data_ != nullptr;
+  }
+
+  auto UploadRing::getBuffer() const -> unsigned int {
+    return buffer_;
+  }
+
+  auto UploadRing::getStallCount() const -> std::size_t {
+    return stalls_;
+  }
+
+  auto UploadRing::advanceFrame() -> void {
+    auto& current = frames_[frame_];
+    glDeleteSync(static_cast<GLsync>(current.fence));
+    current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    frame_ = (frame_ + 1) % FRAMES_IN_FLIGHT;
+    auto& next = frames_[frame_];
+    if (auto fence = static_cast<GLsync>(next.fence); fence) {
+      // a zero timeout only polls, anything else means the GPU is FRAMES_IN_FLIGHT behind
+      auto status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+      if (status == GL_TIMEOUT_EXPIRED) {
+        ++stalls_;
+        do {
+          status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+        } while (status == GL_TIMEOUT_EXPIRED);
+      }
+
+      glDeleteSync(fence);
+      next.fence = nullptr;
+    }
+    next.used = 0;
+  }
+
+  auto UploadRing::allocate(std::size_t size, std::size_t alignment) -> UploadAllocation {
+    auto& frame = frames_[frame_];
+    const auto offset = (frame.used + alignment - 1) / alignment * alignment;
+    if (!data_ || offset > frame_size_ || size > frame_size_ - offset) {
+      return UploadAllocation{};
+    }
+
+    frame.used = offset + size;
+    const auto position = frame_ * frame_size_ + offset;
+    return UploadAllocation{ buffer_, position, data_ + position };
+  }
+
+  auto UploadRing::upload(unsigned int buffer,
+                          std::size_t offset,
+                          const void* data,
+                          std::size_t size) -> void {
+    if (size == 0) {
+      return;
+    }
+
+    // copies only need 4 byte alignment, the uniform alignment would waste room here
+    const auto allocation = allocate(size, sizeof(std::uint32_t));
+    if (!allocation.data) {
+      glNamedBufferSubData(
+          buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+      return;
+    }
+
+    std::memcpy(allocation.data, data, size);
+    glCopyNamedBufferSubData(allocation.buffer,
+                             buffer,
+                             static_cast<GLintptr>(allocation.offset),
+                             static_cast<GLintptr>(offset),
+                             static_cast<GLsizeiptr>(size));
+  }
+
+  auto GetUploadRing() -> UploadRing* {
+    auto* ring = CurrentRing();
+    return ring && ring->isValid() ? ring : nullptr;
+  }
+
+  auto UploadBufferData(unsigned int buffer, std::size_t offset, const void* data, std::size_t size)
+      -> void {
+    if (auto* ring = GetUploadRing(); ring) {
+      ring->upload(buffer, offset, data, size);
+      return;
+    }
+
+    glNamedBufferSubData(
+        buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+  }
+
+}  // namespace brabbit
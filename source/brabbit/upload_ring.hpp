@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace brabbit {
+
+  // Room in the ring for the current frame, written by the CPU and read by GL through `buffer`.
+  struct UploadAllocation {
+    unsigned int buffer{ 0 };
+    std::size_t offset{ 0 };  // into buffer
+    char* data{ nullptr };    // nullptr when the frame is out of room
+  };
+
+  // Persistently mapped staging buffer split into one segment per frame in flight. Writes go
+  // straight into mapped memory and reach their buffers through GPU side copies, so the CPU never
+  // waits on the driver for an upload. A segment is only reused once the fence of the frame that
+  // last filled it has signalled, which also keeps the CPU at most FRAMES_IN_FLIGHT frames ahead.
+  class UploadRing {
+   public:
+    explicit UploadRing(std::size_t frame_size = FRAME_SIZE);
+    virtual ~UploadRing();
+
+    UploadRing(const UploadRing&) = delete;
+    auto operator=(const UploadRing&) -> UploadRing& = delete;
+
+   public:
+    auto isValid() const -> bool;
+    auto getBuffer() const -> unsigned int;
+
+    // Times advanceFrame had to wait for the GPU to release a segment.
+    auto getStallCount() const -> std::size_t;
+
+    // Close the current frame with a fence and open the next segment, waiting for it if needed.
+    // Called once a frame after its commands are issued.
+    auto advanceFrame() -> void;
+
+    auto allocate(std::size_t size, std::size_t alignment = ALIGNMENT) -> UploadAllocation;
+
+    // Copy data into buffer at offset through the ring, a direct glNamedBufferSubData when the
+    // frame is out of room.
+    auto upload(unsigned int buffer, std::size_t offset, const void* data, std::size_t size)
+        -> void;
+
+   public:
+    static constexpr auto FRAMES_IN_FLIGHT = std::size_t{ 3 };
+    static constexpr auto FRAME_SIZE = std::size_t{ 8 } << 20;
+    static constexpr auto ALIGNMENT = std::size_t{ 256 };  // enough for uniform buffer offsets
+
+   private:
+    struct Frame {
+      void* fence{ nullptr };  // GLsync of the last frame that wrote the segment
+      std::size_t used{ 0 };
+    };
+
+   private:
+    unsigned int buffer_{ 0 };
+    char* data_{ nullptr };
+    std::size_t frame_size_{ 0 };
+
+    std::array<Frame, FRAMES_IN_FLIGHT> frames_{};
+    std::size_t frame_{ 0 };
+    std::size_t stalls_{ 0 };
+  };
+
+  // The ring of the window, nullptr before it exists.
+  auto GetUploadRing() -> UploadRing*;
+
+  // Upload through the ring when there is one, glNamedBufferSubData otherwise.
+  auto UploadBufferData(unsigned int buffer, std::size_t offset, const void* data, std::size_t size)
+      -> void;
+
+}  // namespace brabbit
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace brabbit {
+
+  // GL type of a vertex component.
+  template <typename _Type>
+  struct VertexComponent;
+
+  template <>
+  struct VertexComponent<GLfloat> {
+    static constexpr auto TYPE = GLenum{ GL_FLOAT };
+  };
+
+  template <>
+  struct VertexComponent<GLbyte> {
+    static constexpr auto TYPE = GLenum{ GL_BYTE };
+  };
+
+  template <>
+  struct VertexComponent<GLubyte> {
+    static constexpr auto TYPE = GLenum{ GL_UNSIGNED_BYTE };
+  };
+
+  template <>
+  struct VertexComponent<GLshort> {
+    static constexpr auto TYPE = GLenum{ GL_SHORT };
+  };
+
+  template <>
+  struct VertexComponent<GLushort> {
+    static constexpr auto TYPE = GLenum{ GL_UNSIGNED_SHORT };
+  };
+
+  template <>
+  struct VertexComponent<GLint> {
+    static constexpr auto TYPE = GLenum{ GL_INT };
+  };
+
+  template <>
+  struct VertexComponent<GLuint> {
+    static constexpr auto TYPE = GLenum{ GL_UNSIGNED_INT };
+  };
+
+  // Component type and count of a vertex value, a scalar or a glm vector.
+  template <typename _Type>
+  struct VertexValue {
+    using Component = _Type;
+    static constexpr auto COMPONENTS = GLint{ 1 };
+  };
+
+  template <glm::length_t _Length, typename _Type, glm::qualifier _Qualifier>
+  struct VertexValue<glm::vec<_Length, _Type, _Qualifier>> {
+    using Component = _Type;
+    static constexpr auto COMPONENTS = GLint{ _Length };
+  };
+
+  // Attribute at a shader location, read from a binding point. Attributes sharing a binding are
+  // interleaved in one buffer, each binding is its own stream. Normalized integers reach the
+  // shader as floats in [0, 1] or [-1, 1], other integers as integers. A divisor makes the
+  // binding step once per that many instances instead of once per vertex.
+  template <GLuint _Location,
+            typename _Type,
+            GLuint _Binding = 0,
+            bool _Normalized = false,
+            GLuint _Divisor = 0>
+  struct VertexAttribute {
+    using Type = _Type;
+    using Component = typename VertexValue<_Type>::Component;
+
+    static constexpr auto LOCATION = _Location;
+    static constexpr auto BINDING = _Binding;
+    static constexpr auto NORMALIZED = _Normalized;
+    static constexpr auto DIVISOR = _Divisor;
+
+    static constexpr auto COMPONENTS = VertexValue<_Type>::COMPONENTS;
+    static constexpr auto TYPE = VertexComponent<Component>::TYPE;
+    static constexpr auto INTEGER = std::is_integral_v<Component> && !_Normalized;
+    static constexpr auto SIZE = static_cast<GLuint>(sizeof(_Type));
+
+    static_assert(sizeof(_Type) == sizeof(Component) * COMPONENTS, "components must be packed");
+  };
+
+  template <GLuint _Location, typename _Type, GLuint _Binding = 0>
+  using NormalizedAttribute = VertexAttribute<_Location, _Type, _Binding, true>;
+
+  template <GLuint _Location, typename _Type, GLuint _Binding>
+  using InstanceAttribute = VertexAttribute<_Location, _Type, _Binding, false, 1>;
+
+  // Vertex format known at compile time. Strides, offsets and GL types follow from the attribute
+  // list, so a VAO is set up and vertices are packed without repeating them by hand. The same
+  // attributes spread over one binding or several are an interleaved or a split layout.
+  template <typename... _Attributes>
+  class VertexLayout {
+   public:
+    static_assert(sizeof...(_Attributes) > 0, "a layout needs attributes");
+
+    static constexpr auto ATTRIBUTE_COUNT = sizeof...(_Attributes);
+    static constexpr auto BINDING_COUNT = std::size_t{ std::max({ _Attributes::BINDING... }) } + 1;
+
+    // Bytes from one vertex of a binding to the next.
+    static constexpr auto STRIDES = [] {
+      auto strides = std::array<GLuint, BINDING_COUNT>{};
+      ((strides[_Attributes::BINDING] += _Attributes::SIZE), ...);
+      return strides;
+    }();
+
+    // Offset of every attribute in the vertex of its binding, in declaration order.
+    static constexpr auto OFFSETS = [] {
+      auto offsets = std::array<GLuint, ATTRIBUTE_COUNT>{};
+      auto ends = std::array<GLuint, BINDING_COUNT>{};
+      auto index = std::size_t{ 0 };
+      ((offsets[index++] = ends[_Attributes::BINDING],
+        ends[_Attributes::BINDING] += _Attributes::SIZE),
+       ...);
+      return offsets;
+    }();
+
+    static constexpr auto DIVISORS = [] {
+      auto divisors = std::array<GLuint, BINDING_COUNT>{};
+      ((divisors[_Attributes::BINDING] = _Attributes::DIVISOR), ...);
+      return divisors;
+    }();
+
+    static_assert(((DIVISORS[_Attributes::BINDING] == _Attributes::DIVISOR) && ...),
+                  "attributes of a binding share its divisor");
+
+   public:
+    // Formats, binding points and divisors of every attribute, buffers are bound with BindBuffer.
+    static auto Apply(GLuint vao) -> void {
+      auto index = std::size_t{ 0 };
+      (ApplyAttribute<_Attributes>(vao, OFFSETS[index++]), ...);
+    }
+
+    static auto BindBuffer(GLuint vao, GLuint binding, GLuint buffer, GLintptr offset = 0)
+        -> void {
+      const auto stride = static_cast<GLsizei>(STRIDES[binding]);
+      glVertexArrayVertexBuffer(vao, binding, buffer, offset, stride);
+    }
+
+    // Vertices of binding as its buffer holds them, from one array per attribute in declaration
+    // order. Arrays of attributes read from other bindings are ignored, short arrays leave zeros.
+    static auto Pack(GLuint binding,
+                     std::size_t count,
+                     std::span<const typename _Attributes::Type>... arrays)
+        -> std::vector<std::byte> {
+      auto data = std::vector<std::byte>(count * STRIDES[binding]);
+      auto index = std::size_t{ 0 };
+      (PackAttribute<_Attributes>(data, binding, count, OFFSETS[index++], arrays), ...);
+      return data;
+    }
+
+   private:
+    template <typename _Attribute>
+    static auto ApplyAttribute(GLuint vao, GLuint offset) -> void {
+      constexpr auto LOCATION = _Attribute::LOCATION;
+      if constexpr (_Attribute::INTEGER) {
+        glVertexArrayAttribIFormat(vao, LOCATION, _Attribute::COMPONENTS, _Attribute::TYPE, offset);
+      } else {
+        glVertexArrayAttribFormat(vao,
+                                  LOCATION,
+                                  _Attribute::COMPONENTS,
+                                  _Attribute::TYPE,
+                                  _Attribute::NORMALIZED ? GL_TRUE : GL_FALSE,
+                                  offset);
+      }
+      glVertexArrayAttribBinding(vao, LOCATION, _Attribute::BINDING);
+      glVertexArrayBindingDivisor(vao, _Attribute::BINDING, _Attribute::DIVISOR);
+      glEnableVertexArrayAttrib(vao, LOCATION);
+    }
+
+    template <typename _Attribute>
+    static auto PackAttribute(std::vector<std::byte>& data,
+                              GLuint binding,
+                              std::size_t count,
+                              GLuint offset,
+                              std::span<const typename _Attribute::Type> array) -> void {
+      if (_Attribute::BINDING != binding) {
+        return;
+      }
+
+      const auto stride = STRIDES[binding];
+      for (auto i = std::size_t{ 0 }; i < std::min(count, array.size()); ++i) {
+        std::memcpy(data.data() + i * stride + offset, &array[i], _Attribute::SIZE);
+      }
+    }
+  };
+
+}  // namespace brabbit
@@ -0,0 +1,508 @@
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <brabbit/parallel.hpp>
+#include <brabbit/voxel.hpp>
+
+namespace brabbit {
+
+  namespace {
+
+    constexpr auto GRAIN = std::size_t{ 4096 };
+    constexpr auto MAX_RESOLUTION = 1 << 21;  // BrickMap keys hold 21 bits per axis
+
+    auto GetVoxelIndex(const glm::ivec3& local) -> int {
+      return local.x + BRICK_SIZE * (local.y + BRICK_SIZE * local.z);
+    }
+
+    auto GetBrick(const glm::ivec3& voxel) -> glm::ivec3 {
+      return voxel / BRICK_SIZE;
+    }
+
+    // index of a brick in the 3x3x3 block around another, offset in [0, 2]
+    auto GetNeighborIndex(const glm::ivec3& offset) -> int {
+      return offset.x + 3 * (offset.y + 3 * offset.z);
+    }
+
+    // Separating axis test of a triangle against a box (Akenine-Moller).
+    auto OverlapsBox(const glm::vec3& center,
+                     const glm::vec3& half_size,
+                     const glm::vec3& a,
+                     const glm::vec3& b,
+                     const glm::vec3& c) -> bool {
+      const auto vertices = std::array{ a - center, b - center, c - center };
+      const auto edges = std::array{ vertices[1] - vertices[0],
+                                     vertices[2] - vertices[1],
+                                     vertices[0] - vertices[2] };
+
+      const auto separated = [&](const glm::vec3& axis) {
+        const auto p0 = glm::dot(axis, vertices[0]);
+        const auto p1 = glm::dot(axis, vertices[1]);
+        const auto p2 = glm::dot(axis, vertices[2]);
+        const auto radius = glm::dot(half_size, glm::abs(axis));
+        return std::min({ p0, p1, p2 }) > radius || std::max({ p0, p1, p2 }) < -radius;
+      };
+
+      for (auto axis = 0; axis < 3; ++axis) {
+        auto unit = glm::vec3{ 0.0f };
+        unit[axis] = 1.0f;
+        if (separated(unit)) {
+          return false;
+        }
+
+        for (const auto& edge : edges) {
+          if (separated(glm::cross(unit, edge))) {
+            return false;
+          }
+        }
+      }
+
+      return !separated(glm::cross(edges[0], edges[1]));
+    }
+
+  }  // namespace
+
+  VoxelGrid::VoxelGrid() = default;
+
+  VoxelGrid::VoxelGrid(const Mesh& mesh, float voxel_size) : voxel_size_{ voxel_size } {
+    const auto& vertices = mesh.getVertices();
+    const auto& indices = mesh.getIndices();
+    if (indices.empty() || voxel_size_ <= 0.0f) {
+      return;
+    }
+
+    // one voxel of padding keeps every surface voxel away from the grid border
+    const auto bounds = mesh.getBounds();
+    origin_ = bounds.min - voxel_size_;
+    resolution_ = glm::min(glm::ivec3{ glm::ceil(bounds.getExtent() / voxel_size_) } + 2,
+                           glm::ivec3{ MAX_RESOLUTION });
+
+    const auto clamp_voxel = [this](const glm::ivec3& voxel) {
+      return glm::clamp(voxel, glm::ivec3{ 0 }, resolution_ - 1);
+    };
+
+    // (brick, triangle) pairs for every brick a triangle's bounds touch
+    using Pair = std::pair<std::uint64_t, std::uint32_t>;
+    auto partials = std::vector<std::vector<Pair>>(GetParallelChunkCount(indices.size(), GRAIN));
+    ParallelFor(indices.size(), GRAIN, [&](auto chunk, auto begin, auto end) {
+      auto& pairs = partials[chunk];
+      for (auto i = begin; i < end; ++i) {
+        const auto& triangle = indices[i];
+        const auto& a = vertices[triangle.x];
+        const auto& b = vertices[triangle.y];
+        const auto& c = vertices[triangle.z];
+        const auto low = GetBrick(clamp_voxel(getVoxel(glm::min(glm::min(a, b), c))));
+        const auto high = GetBrick(clamp_voxel(getVoxel(glm::max(glm::max(a, b), c))));
+
+        for (auto z = low.z; z <= high.z; ++z) {
+          for (auto y = low.y; y <= high.y; ++y) {
+            for (auto x = low.x; x <= high.x; ++x) {
+              pairs.emplace_back(BrickMap<Brick>::GetKey({ x, y, z }), static_cast<std::uint32_t>(i));
+            }
+          }
+        }
+      }
+    });
+
+    auto pairs = std::vector<Pair>{};
+    for (auto& partial : partials) {
+      pairs.insert(pairs.end(), partial.begin(), partial.end());
+      partial = {};
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    // allocate the bricks up front, then every brick is rasterized independently
+    auto ranges = std::vector<std::pair<std::size_t, std::size_t>>{};
+    for (auto begin = std::size_t{ 0 }; begin < pairs.size();) {
+      auto end = begin;
+      while (end < pairs.size() && pairs[end].first == pairs[begin].first) {
+        ++end;
+      }
+
+      const auto key = pairs[begin].first;
+      const auto mask = (std::uint64_t{ 1 } << 21) - 1;
+      const auto brick = glm::ivec3{
+        static_cast<int>(key & mask),
+        static_cast<int>((key >> 21) & mask),
+        static_cast<int>(key >> 42),
+      };
+      bricks_.emplace(brick, Brick{});
+      ranges.emplace_back(begin, end);
+      begin = end;
+    }
+
+    const auto half_size = glm::vec3{ voxel_size_ * 0.5f };
+    ParallelFor(ranges.size(), 1, [&](auto, auto begin, auto end) {
+      for (auto index = begin; index < end; ++index) {
+        const auto& brick_coordinate = bricks_.getCoordinates()[index];
+        auto& brick = bricks_.getBricks()[index];
+        const auto brick_low = brick_coordinate * BRICK_SIZE;
+        const auto brick_high = brick_low + BRICK_SIZE - 1;
+
+        for (auto i = ranges[index].first; i < ranges[index].second; ++i) {
+          const auto& triangle = indices[pairs[i].second];
+          const auto& a = vertices[triangle.x];
+          const auto& b = vertices[triangle.y];
+          const auto& c = vertices[triangle.z];
+          const auto low = glm::max(clamp_voxel(getVoxel(glm::min(glm::min(a, b), c))), brick_low);
+          const auto high = glm::min(clamp_voxel(getVoxel(glm::max(glm::max(a, b), c))), brick_high);
+
+          for (auto z = low.z; z <= high.z; ++z) {
+            for (auto y = low.y; y <= high.y; ++y) {
+              for (auto x = low.x; x <= high.x; ++x) {
+                const auto voxel = glm::ivec3{ x, y, z };
+                const auto bit = GetVoxelIndex(voxel - brick_low);
+                if (brick[bit / 64] & (std::uint64_t{ 1 } << (bit % 64))) {
+                  continue;
+                }
+
+                if (OverlapsBox(getVoxelCenter(voxel), half_size, a, b, c)) {
+                  brick[bit / 64] |= std::uint64_t{ 1 } << (bit % 64);
+                }
+              }
+            }
+          }
+        }
+      }
+    });
+  }
+
+  auto VoxelGrid::getOrigin() const -> const glm::vec3& {
+    return origin_;
+  }
+
+  auto VoxelGrid::getVoxelSize() const -> float {
+    return voxel_size_;
+  }
+
+  auto VoxelGrid::getResolution() const -> const glm::ivec3& {
+    return resolution_;
+  }
+
+  auto VoxelGrid::getVoxel(const glm::vec3& position) const -> glm::ivec3 {
+    return glm::ivec3{ glm::floor((position - origin_) / voxel_size_) };
+  }
+
+  auto VoxelGrid::getVoxelCenter(const glm::ivec3& voxel) const -> glm::vec3 {
+    return origin_ + (glm::vec3{ voxel } + 0.5f) * voxel_size_;
+  }
+
+  auto VoxelGrid::isOccupied(const glm::ivec3& voxel) const -> bool {
+    if (glm::any(glm::lessThan(voxel, glm::ivec3{ 0 })) ||
+        glm::any(glm::greaterThanEqual(voxel, resolution_))) {
+      return false;
+    }
+
+    const auto* brick = bricks_.find(GetBrick(voxel));
+    if (!brick) {
+      return false;
+    }
+
+    const auto bit = GetVoxelIndex(voxel % BRICK_SIZE);
+    return (*brick)[bit / 64] & (std::uint64_t{ 1 } << (bit % 64));
+  }
+
+  auto VoxelGrid::getBricks() const -> const BrickMap<Brick>& {
+    return bricks_;
+  }
+
+  DistanceField::DistanceField() = default;
+
+  DistanceField::DistanceField(const Mesh& mesh, const VoxelGrid& grid, int band)
+      : origin_{ grid.getOrigin() },
+        voxel_size_{ grid.getVoxelSize() },
+        band_width_{ static_cast<float>(std::max(band, 1)) * grid.getVoxelSize() } {
+    const auto& vertices = mesh.getVertices();
+    const auto& indices = mesh.getIndices();
+    const auto& occupied = grid.getBricks();
+    if (indices.empty() || occupied.size() == 0) {
+      return;
+    }
+
+    band = std::max(band, 1);
+
+    // Band bricks: the occupied bricks dilated by the band, sorted into +X rows of bricks.
+    const auto reach = (band + BRICK_SIZE - 1) / BRICK_SIZE;
+    const auto brick_limit = (grid.getResolution() + BRICK_SIZE - 1) / BRICK_SIZE - 1;
+    auto coordinates = std::vector<glm::ivec3>{};
+    for (const auto& brick : occupied.getCoordinates()) {
+      for (auto z = -reach; z <= reach; ++z) {
+        for (auto y = -reach; y <= reach; ++y) {
+          for (auto x = -reach; x <= reach; ++x) {
+            const auto neighbor = brick + glm::ivec3{ x, y, z };
+            if (glm::all(glm::greaterThanEqual(neighbor, glm::ivec3{ 0 })) &&
+                glm::all(glm::lessThanEqual(neighbor, brick_limit))) {
+              coordinates.push_back(neighbor);
+            }
+          }
+        }
+      }
+    }
+
+    std::sort(coordinates.begin(), coordinates.end(), [](const auto& lhs, const auto& rhs) {
+      return std::tie(lhs.z, lhs.y, lhs.x) < std::tie(rhs.z, rhs.y, rhs.x);
+    });
+    coordinates.erase(std::unique(coordinates.begin(), coordinates.end()), coordinates.end());
+
+    // Jump flooding of closest triangle ids, seeded with the exact closest triangle of every
+    // occupied voxel. Two id maps share the brick layout of bricks_ and are swapped every step.
+    using Seeds = std::array<std::uint32_t, BRICK_VOXELS>;
+    auto seeds = BrickMap<Seeds>{};
+    for (const auto& coordinate : coordinates) {
+      seeds.emplace(coordinate, Seeds{});
+      bricks_.emplace(coordinate, Brick{});
+    }
+
+    const auto brick_count = coordinates.size();
+    const auto seed_distance = voxel_size_ * 0.87f;  // half the voxel diagonal
+    ParallelFor(brick_count, 1, [&](auto, auto begin, auto end) {
+      for (auto index = begin; index < end; ++index) {
+        const auto brick_low = coordinates[index] * BRICK_SIZE;
+        auto& brick = seeds.getBricks()[index];
+        for (auto i = 0; i < BRICK_VOXELS; ++i) {
+          const auto voxel = brick_low + glm::ivec3{ i % BRICK_SIZE,
+                                                     (i / BRICK_SIZE) % BRICK_SIZE,
+                                                     i / (BRICK_SIZE * BRICK_SIZE) };
+          brick[i] = INVALID_INDEX;
+          if (grid.isOccupied(voxel)) {
+            brick[i] = mesh.closestPoint(grid.getVoxelCenter(voxel), seed_distance * 2.0f).primitive;
+          }
+        }
+      }
+    });
+
+    const auto distance_to = [&](std::uint32_t triangle, const glm::vec3& point) {
+      const auto& ids = indices[triangle];
+      const auto closest =
+          ClosestPointOnTriangle(point, vertices[ids.x], vertices[ids.y], vertices[ids.z]);
+      return glm::length(closest - point);
+    };
+
+    auto steps = std::vector<int>{};
+    for (auto step = 1; step < band * 2; step *= 2) {
+      steps.insert(steps.begin(), step);
+    }
+    steps.push_back(1);  // JFA+1 fixes most of the remaining errors
+
+    // neighbor bricks are resolved once, only steps wider than a brick fall back to the hash map
+    auto neighbors = std::vector<std::array<std::uint32_t, 27>>(brick_count);
+    ParallelFor(brick_count, 64, [&](auto, auto begin, auto end) {
+      for (auto index = begin; index < end; ++index) {
+        for (auto i = 0; i < 27; ++i) {
+          const auto offset = glm::ivec3{ i % 3, (i / 3) % 3, i / 9 };
+          neighbors[index][GetNeighborIndex(offset)] =
+              seeds.findIndex(coordinates[index] + offset - 1);
+        }
+      }
+    });
+
+    auto next = seeds;
+    for (const auto step : steps) {
+      ParallelFor(brick_count, 1, [&](auto, auto begin, auto end) {
+        for (auto index = begin; index < end; ++index) {
+          const auto brick_low = coordinates[index] * BRICK_SIZE;
+          const auto& current_brick = seeds.getBricks()[index];
+          auto& next_brick = next.getBricks()[index];
+
+          for (auto i = 0; i < BRICK_VOXELS; ++i) {
+            const auto voxel = brick_low + glm::ivec3{ i % BRICK_SIZE,
+                                                       (i / BRICK_SIZE) % BRICK_SIZE,
+                                                       i / (BRICK_SIZE * BRICK_SIZE) };
+            const auto center = grid.getVoxelCenter(voxel);
+
+            auto best = current_brick[i];
+            auto best_distance = best == INVALID_INDEX ? std::numeric_limits<float>::infinity()
+                                                       : distance_to(best, center);
+
+            for (auto z = -1; z <= 1; ++z) {
+              for (auto y = -1; y <= 1; ++y) {
+                for (auto x = -1; x <= 1; ++x) {
+                  const auto neighbor = voxel + glm::ivec3{ x, y, z } * step;
+                  if (glm::any(glm::lessThan(neighbor, glm::ivec3{ 0 }))) {
+                    continue;
+                  }
+
+                  const auto brick_offset = GetBrick(neighbor) - coordinates[index] + 1;
+                  const auto* brick = static_cast<const Seeds*>(nullptr);
+                  if (glm::all(glm::greaterThanEqual(brick_offset, glm::ivec3{ 0 })) &&
+                      glm::all(glm::lessThan(brick_offset, glm::ivec3{ 3 }))) {
+                    const auto cached = neighbors[index][GetNeighborIndex(brick_offset)];
+                    brick = cached == INVALID_INDEX ? nullptr : &seeds.getBricks()[cached];
+                  } else {
+                    brick = seeds.find(GetBrick(neighbor));
+                  }
+
+                  if (!brick) {
+                    continue;
+                  }
+
+                  const auto candidate = (*brick)[GetVoxelIndex(neighbor % BRICK_SIZE)];
+                  if (candidate == INVALID_INDEX || candidate == best) {
+                    continue;
+                  }
+
+                  const auto distance = distance_to(candidate, center);
+                  if (distance < best_distance) {
+                    best = candidate;
+                    best_distance = distance;
+                  }
+                }
+              }
+            }
+
+            next_brick[i] = best;
+          }
+        }
+      });
+
+      std::swap(seeds, next);
+    }
+
+    // Winding numbers along +X: one ray per voxel row of every row of bricks gathers all signed
+    // crossings, voxels then sum the crossings in front of them. Nonzero winding is inside.
+    auto rows = std::vector<std::pair<std::size_t, std::size_t>>{};
+    for (auto begin = std::size_t{ 0 }; begin < brick_count;) {
+      auto end = begin;
+      while (end < brick_count && coordinates[end].y == coordinates[begin].y &&
+             coordinates[end].z == coordinates[begin].z) {
+        ++end;
+      }
+      rows.emplace_back(begin, end);
+      begin = end;
+    }
+
+    const auto& bvh = mesh.getBvh();
+    const auto jitter = glm::vec2{ 0.00173f, 0.00291f } * voxel_size_;  // keep rays off edges
+    auto inside = std::vector<std::uint8_t>(brick_count);  // sign behind every band brick
+    ParallelFor(rows.size(), 1, [&](auto, auto begin, auto end) {
+      auto crossings = std::vector<std::pair<float, int>>{};
+      for (auto row = begin; row < end; ++row) {
+        const auto [first, last] = rows[row];
+        const auto brick_low = coordinates[first] * BRICK_SIZE;
+
+        for (auto z = 0; z < BRICK_SIZE; ++z) {
+          for (auto y = 0; y < BRICK_SIZE; ++y) {
+            const auto center = grid.getVoxelCenter(brick_low + glm::ivec3{ 0, y, z });
+            const auto ray = Ray{
+              { origin_.x - voxel_size_, center.y + jitter.x, center.z + jitter.y },
+              { 1.0f, 0.0f, 0.0f },
+            };
+
+            crossings.clear();
+            bvh.traverse(ray, std::numeric_limits<float>::infinity(), [&](auto primitive, auto&) {
+              const auto& ids = indices[primitive];
+              const auto& a = vertices[ids.x];
+              const auto& b = vertices[ids.y];
+              const auto& c = vertices[ids.z];
+              auto hit = RayHit{};
+              if (IntersectTriangle(ray, a, b, c, hit)) {
+                const auto normal = glm::cross(b - a, c - a);
+                crossings.emplace_back(ray.origin.x + hit.distance, normal.x < 0.0f ? 1 : -1);
+              }
+            });
+            std::sort(crossings.begin(), crossings.end());
+
+            auto winding = 0;
+            auto crossing = crossings.begin();
+            for (auto index = first; index < last; ++index) {
+              const auto voxel_low = coordinates[index] * BRICK_SIZE;
+              auto& brick = bricks_.getBricks()[index];
+              const auto& ids = seeds.getBricks()[index];
+
+              for (auto x = 0; x < BRICK_SIZE; ++x) {
+                const auto voxel = voxel_low + glm::ivec3{ x, y, z };
+                const auto point = grid.getVoxelCenter(voxel);
+                while (crossing != crossings.end() && crossing->first < point.x) {
+                  winding += crossing->second;
+                  ++crossing;
+                }
+
+                const auto i = GetVoxelIndex({ x, y, z });
+                auto distance = ids[i] == INVALID_INDEX ? band_width_ : distance_to(ids[i], point);
+                distance = std::min(distance, band_width_) * (winding != 0 ? -1.0f : 1.0f);
+                brick[i] = static_cast<std::int16_t>(std::lround(distance / band_width_ * 32767.0f));
+              }
+
+              if (y == BRICK_SIZE / 2 && z == BRICK_SIZE / 2) {
+                inside[index] = winding != 0;
+              }
+            }
+          }
+        }
+      }
+    });
+
+    // Unallocated bricks hold no surface, each run of them along +X takes the sign found behind
+    // the band brick in front of it. Runs before the first band brick of a row are outside.
+    const auto brick_end = brick_limit.x + 1;
+    for (const auto& [first, last] : rows) {
+      for (auto index = first; index < last; ++index) {
+        const auto& coordinate = coordinates[index];
+        const auto end = index + 1 < last ? coordinates[index + 1].x : brick_end;
+        if (inside[index] && coordinate.x + 1 < end) {
+          inside_runs_.emplace_back(coordinate.x + 1, end, coordinate.y, coordinate.z);
+        }
+      }
+    }
+  }
+
+  auto DistanceField::getOrigin() const -> const glm::vec3& {
+    return origin_;
+  }
+
+  auto DistanceField::getVoxelSize() const -> float {
+    return voxel_size_;
+  }
+
+  auto DistanceField::getBandWidth() const -> float {
+    return band_width_;
+  }
+
+  auto DistanceField::getDistance(const glm::ivec3& voxel) const -> float {
+    if (glm::any(glm::lessThan(voxel, glm::ivec3{ 0 }))) {
+      return band_width_;
+    }
+
+    const auto coordinate = GetBrick(voxel);
+    const auto* brick = bricks_.find(coordinate);
+    if (!brick) {
+      return isInside(coordinate) ? -band_width_ : band_width_;
+    }
+
+    return (*brick)[GetVoxelIndex(voxel % BRICK_SIZE)] / 32767.0f * band_width_;
+  }
+
+  auto DistanceField::sample(const glm::vec3& position) const -> float {
+    const auto coordinate = (position - origin_) / voxel_size_ - 0.5f;
+    const auto low = glm::ivec3{ glm::floor(coordinate) };
+    const auto t = coordinate - glm::vec3{ low };
+
+    auto result = 0.0f;
+    for (auto corner = 0; corner < 8; ++corner) {
+      const auto offset = glm::ivec3{ corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+      const auto weight = (offset.x ? t.x : 1.0f - t.x) * (offset.y ? t.y : 1.0f - t.y) *
+                          (offset.z ? t.z : 1.0f - t.z);
+      result += weight * getDistance(low + offset);
+    }
+    return result;
+  }
+
+  auto DistanceField::getBricks() const -> const BrickMap<Brick>& {
+    return bricks_;
+  }
+
+  auto DistanceField::isInside(const glm::ivec3& brick) const -> bool {
+    const auto run = std::upper_bound(
+        inside_runs_.begin(), inside_runs_.end(), brick, [](const auto& key, const auto& run) {
+          return std::tie(key.z, key.y, key.x) < std::tie(run.w, run.z, run.x);
+        });
+    if (run == inside_runs_.begin()) {
+      return false;
+    }
+
+    const auto& previous = *std::prev(run);
+    return previous.w == brick.z && previous.z == brick.y && brick.x < previous.y;
+  }
+
+}  // namespace brabbit
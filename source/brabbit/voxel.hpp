@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/mesh.hpp>
+
+namespace brabbit {
+
+  constexpr auto BRICK_SIZE = 8;
+  constexpr auto BRICK_VOXELS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+  // Sparse storage of BRICK_SIZE^3 voxel bricks, only bricks that were touched are allocated.
+  template <typename _Brick>
+  class BrickMap {
+   public:
+    auto size() const -> std::size_t {
+      return bricks_.size();
+    }
+
+    auto getCoordinates() const -> const std::vector<glm::ivec3>& {
+      return coordinates_;
+    }
+
+    auto getBricks() const -> const std::vector<_Brick>& {
+      return bricks_;
+    }
+
+    auto getBricks() -> std::vector<_Brick>& {
+      return bricks_;
+    }
+
+    auto find(const glm::ivec3& brick) const -> const _Brick* {
+      if (glm::any(glm::lessThan(brick, glm::ivec3{ 0 }))) {
+        return nullptr;
+      }
+
+      auto iter = lookup_.find(GetKey(brick));
+      return iter == lookup_.end() ? nullptr : &bricks_[iter->second];
+    }
+
+    // Position of a brick in getBricks(), INVALID_INDEX when it is not allocated.
+    auto findIndex(const glm::ivec3& brick) const -> std::uint32_t {
+      if (glm::any(glm::lessThan(brick, glm::ivec3{ 0 }))) {
+        return INVALID_INDEX;
+      }
+
+      auto iter = lookup_.find(GetKey(brick));
+      return iter == lookup_.end() ? INVALID_INDEX : static_cast<std::uint32_t>(iter->second);
+    }
+
+    auto emplace(const glm::ivec3& brick, const _Brick& value) -> _Brick& {
+      auto [iter, inserted] = lookup_.emplace(GetKey(brick), bricks_.size());
+      if (inserted) {
+        coordinates_.push_back(brick);
+        bricks_.push_back(value);
+      }
+      return bricks_[iter->second];
+    }
+
+    // Brick coordinates are packed 21 bits per axis, grids keep them non negative.
+    static auto GetKey(const glm::ivec3& brick) -> std::uint64_t {
+      return static_cast<std::uint64_t>(brick.x) | static_cast<std::uint64_t>(brick.y) << 21 |
+             static_cast<std::uint64_t>(brick.z) << 42;
+    }
+
+   private:
+    std::unordered_map<std::uint64_t, std::size_t> lookup_{};
+    std::vector<glm::ivec3> coordinates_{};
+    std::vector<_Brick> bricks_{};
+  };
+
+  // Conservative occupancy of a mesh: a voxel is set when any triangle touches its box.
+  // Triangles are binned to bricks and every brick is rasterized on its own worker chunk.
+  class VoxelGrid {
+   public:
+    using Brick = std::array<std::uint64_t, BRICK_VOXELS / 64>;
+
+   public:
+    explicit VoxelGrid();
+    explicit VoxelGrid(const Mesh& mesh, float voxel_size);
+    virtual ~VoxelGrid() = default;
+
+   public:
+    auto getOrigin() const -> const glm::vec3&;
+    auto getVoxelSize() const -> float;
+    auto getResolution() const -> const glm::ivec3&;
+
+    auto getVoxel(const glm::vec3& position) const -> glm::ivec3;
+    auto getVoxelCenter(const glm::ivec3& voxel) const -> glm::vec3;
+
+    auto isOccupied(const glm::ivec3& voxel) const -> bool;
+
+    auto getBricks() const -> const BrickMap<Brick>&;
+
+   private:
+    glm::vec3 origin_{ 0.0f, 0.0f, 0.0f };
+    float voxel_size_{ 1.0f };
+    glm::ivec3 resolution_{ 0, 0, 0 };
+    BrickMap<Brick> bricks_{};
+  };
+
+  // Narrow band signed distance field on the grid of a voxelization, negative inside.
+  // Closest triangles are spread from the occupied voxels by jump flooding, the sign comes from
+  // the winding number along +X rows. Distances are stored as 16 bit fractions of the band, bricks
+  // beyond the band are not allocated and only keep their sign.
+  class DistanceField {
+   public:
+    using Brick = std::array<std::int16_t, BRICK_VOXELS>;
+
+   public:
+    explicit DistanceField();
+    explicit DistanceField(const Mesh& mesh, const VoxelGrid& grid, int band = 3);
+    virtual ~DistanceField() = default;
+
+   public:
+    auto getOrigin() const -> const glm::vec3&;
+    auto getVoxelSize() const -> float;
+
+    // Width of the band in world units, voxels outside the band report -band width inside the
+    // surface and +band width outside of it.
+    auto getBandWidth() const -> float;
+
+    auto getDistance(const glm::ivec3& voxel) const -> float;
+
+    // Trilinear interpolation between voxel centers.
+    auto sample(const glm::vec3& position) const -> float;
+
+    auto getBricks() const -> const BrickMap<Brick>&;
+
+   private:
+    auto isInside(const glm::ivec3& brick) const -> bool;
+
+   private:
+    glm::vec3 origin_{ 0.0f, 0.0f, 0.0f };
+    float voxel_size_{ 1.0f };
+    float band_width_{ 0.0f };
+    BrickMap<Brick> bricks_{};
+    // runs of unallocated bricks inside along +X as first x, end x, y, z, sorted by z, y, x
+    std::vector<glm::ivec4> inside_runs_{};
+  };
+
+}  // namespace brabbit
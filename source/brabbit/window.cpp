@@ -1,5 +1,7 @@
 #include <filesystem>
 
+#include <brabbit/render_state.hpp>
+#include <brabbit/shader_compiler.hpp>
 #include <brabbit/window.hpp>
 #include <stb/stb_image_write.h>
 
@@ -37,12 +39,17 @@ namespace brabbit {
       return;
     }
 
+    // every program starts compiling now, the first frames draw whatever is ready
+    LoadParallelShaderCompile((GLADloadproc)glfwGetProcAddress);
+    PreloadShaders();
+
     if (const auto* version = glGetString(GL_VERSION); version) {
       // std::cout << "OpenGL version: "sv << version << std::endl;
     }
 
     // Init the OpenGL view area, at this call it will also init the window's size.
-    glViewport(0, 0, width_, height_);
+    auto& state = GetRenderState();
+    state.setViewport(0, 0, width_, height_);
 
     // Init the window's position at center of primary monitor.
     do {
@@ -67,11 +74,17 @@ namespace brabbit {
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);  // wireframe mode
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glEnable(GL_DEPTH_TEST);  // enable depth test (use to hide the object behind another object)
+    // enable depth test (use to hide the object behind another object)
+    state.setEnabled(GL_DEPTH_TEST, true);
     glClearColor(0.7f, 0.7f, 0.7f, 0.0f);  // set clear color
+
+    // buffer uploads stream through here once it exists, models created later use it too
+    upload_ring_ = std::make_unique<UploadRing>();
   }
 
   Window::~Window() {
+    upload_ring_.reset();
+
     if (handle_) {
       glfwDestroyWindow(handle_);
     }
@@ -161,7 +174,7 @@ namespace brabbit {
       if (width != width_ || height != height_) {
         width_ = width;
         height_ = height;
-        glViewport(0, 0, width_, height_);
+        GetRenderState().setViewport(0, 0, width_, height_);
 
         if (scene_) {
           auto* camera = scene_->getCamera();
@@ -199,6 +212,12 @@ namespace brabbit {
       scene_->processFrame(delta);
       after_process_frame(delta);
 
+      // fences the frame's uploads, waits when the GPU is too many frames behind
+      if (upload_ring_) {
+        upload_ring_->advanceFrame();
+      }
+      GetRenderState().endFrame();
+
       glfwSwapBuffers(handle_);  // swap front and back buffers
       glfwPollEvents();  // poll for and process events
     }
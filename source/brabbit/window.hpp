@@ -12,6 +12,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <brabbit/scene.hpp>
+#include <brabbit/upload_ring.hpp>
 
 namespace brabbit {
 
@@ -68,6 +69,7 @@ namespace brabbit {
     std::size_t width_{ 800 };
     std::size_t height_{ 600 };
     std::unique_ptr<Scene> scene_{ nullptr };
+    std::unique_ptr<UploadRing> upload_ring_{ nullptr };
   };
 
 }  // namespace brabbit
@@ -0,0 +1,251 @@
+// Bake a single resource into the form the demo loads at runtime, run once per file by the build.
+// usage: asset_baker model <input stl> <output mesh>
+//        asset_baker shader <input shader> <output shader>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <brabbit/mesh_format.hpp>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+  auto ReadWholeFile(const std::filesystem::path& path, std::vector<char>& data) -> bool {
+    auto file = std::ifstream{ path, std::ios::binary | std::ios::ate };
+    if (!file) {
+      return false;
+    }
+
+    data.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(data.data(), static_cast<std::streamsize>(data.size())));
+  }
+
+  // written next to the target and renamed, a failed run never leaves half an output behind
+  auto WriteWholeFile(const std::filesystem::path& path, std::string_view data) -> bool {
+    auto error = std::error_code{};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+      auto file = std::ofstream{ temporary, std::ios::binary | std::ios::trunc };
+      file.write(data.data(), static_cast<std::streamsize>(data.size()));
+      if (!file) {
+        std::fprintf(stderr, "asset_baker: can not write %s\n", temporary.string().c_str());
+        return false;
+      }
+    }
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+      std::fprintf(stderr, "asset_baker: can not replace %s\n", path.string().c_str());
+      return false;
+    }
+    return true;
+  }
+
+  auto BakeModel(const std::filesystem::path& input, const std::filesystem::path& output) -> bool {
+    auto data = std::vector<char>{};
+    if (!ReadWholeFile(input, data)) {
+      std::fprintf(stderr, "%s: error: can not read\n", input.string().c_str());
+      return false;
+    }
+
+    const auto mesh = brabbit::ParseStl(data);
+    if (mesh.indices.empty()) {
+      std::fprintf(stderr, "%s: error: no facets\n", input.string().c_str());
+      return false;
+    }
+
+    const auto baked = brabbit::BakeMesh(mesh);
+    auto header = brabbit::BakedMeshHeader{};
+    std::memcpy(&header, baked.data(), sizeof(header));
+    std::printf("%s: %zu vertices welded into %u\n",
+                input.filename().string().c_str(),
+                mesh.vertices.size(),
+                header.vertex_count);
+    return WriteWholeFile(output, { baked.data(), baked.size() });
+  }
+
+  // Shader source with includes resolved and comments removed. Line breaks are kept, so line
+  // numbers in driver messages still point into the original files.
+  class ShaderBaker {
+   public:
+    auto bake(const std::filesystem::path& input, std::string& output) -> bool {
+      return expand(input, output) && validate(input, output);
+    }
+
+   private:
+    auto error(const std::filesystem::path& file, std::size_t line, const char* message) -> bool {
+      std::fprintf(stderr, "%s:%zu: error: %s\n", file.string().c_str(), line, message);
+      return false;
+    }
+
+    // `#include "name"` relative to the including file, announced by #line with the index of the
+    // file in the order first seen as source string number.
+    auto expand(const std::filesystem::path& path, std::string& output) -> bool {
+      const auto canonical = std::filesystem::weakly_canonical(path);
+      for (const auto& open : stack_) {
+        if (open == canonical) {
+          return error(path, 1, "recursive include");
+        }
+      }
+
+      auto data = std::vector<char>{};
+      if (!ReadWholeFile(path, data)) {
+        return error(path, 1, "can not read");
+      }
+
+      const auto source_index = files_.size();
+      files_.push_back(canonical);
+      stack_.push_back(canonical);
+
+      const auto stripped = stripComments({ data.data(), data.size() });
+      auto text = std::string_view{ stripped };
+      auto line_number = std::size_t{ 0 };
+      while (!text.empty()) {
+        const auto end = text.find('\n');
+        const auto line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++line_number;
+
+        const auto directive = line.substr(std::min(line.find_first_not_of(" \t"), line.size()));
+        if (!directive.starts_with("#include"sv)) {
+          output.append(line).push_back('\n');
+          continue;
+        }
+
+        const auto open = directive.find('"');
+        const auto close = open == std::string_view::npos ? open : directive.find('"', open + 1);
+        if (close == std::string_view::npos) {
+          return error(path, line_number, "expected #include \"file\"");
+        }
+
+        const auto name = directive.substr(open + 1, close - open - 1);
+        const auto included = path.parent_path() / std::filesystem::path{ name };
+        output.append("#line 1 ").append(std::to_string(files_.size())).push_back('\n');
+        if (!expand(included, output)) {
+          return error(path, line_number, "included from here");
+        }
+        output.append("#line ")
+            .append(std::to_string(line_number + 1))
+            .append(" ")
+            .append(std::to_string(source_index))
+            .push_back('\n');
+      }
+
+      stack_.pop_back();
+      return true;
+    }
+
+    static auto stripComments(std::string_view text) -> std::string {
+      auto result = std::string{};
+      result.reserve(text.size());
+      for (auto i = std::size_t{ 0 }; i < text.size(); ++i) {
+        if (text.substr(i).starts_with("//"sv)) {
+          i = std::min(text.find('\n', i), text.size()) - 1;
+        } else if (text.substr(i).starts_with("/*"sv)) {
+          const auto end = std::min(text.find("*/"sv, i + 2), text.size());
+          result.append(static_cast<std::size_t>(std::count(
+                            text.begin() + static_cast<std::ptrdiff_t>(i),
+                            text.begin() + static_cast<std::ptrdiff_t>(end), '\n')),
+                        '\n');
+          i = std::min(end + 1, text.size());
+        } else if (text[i] != '\r') {
+          result.push_back(text[i]);
+        }
+      }
+
+      // trailing blanks left behind by comments
+      auto trimmed = std::string{};
+      trimmed.reserve(result.size());
+      for (const auto ch : result) {
+        if (ch == '\n') {
+          while (!trimmed.empty() && (trimmed.back() == ' ' || trimmed.back() == '\t')) {
+            trimmed.pop_back();
+          }
+        }
+        trimmed.push_back(ch);
+      }
+      return trimmed;
+    }
+
+    // Structural checks only, the GLSL compiler lives in the driver: #version leads the source,
+    // brackets balance and there is a main.
+    auto validate(const std::filesystem::path& path, std::string_view source) -> bool {
+      const auto first = source.find_first_not_of(" \t\n");
+      if (first == std::string_view::npos || !source.substr(first).starts_with("#version"sv)) {
+        return error(path, 1, "#version must come first");
+      }
+
+      auto brackets = std::string{};
+      auto line_number = std::size_t{ 1 };
+      for (const auto ch : source) {
+        switch (ch) {
+          case '\n':
+            ++line_number;
+            break;
+
+          case '{':
+          case '(':
+          case '[':
+            brackets.push_back(ch);
+            break;
+
+          case '}':
+          case ')':
+          case ']': {
+            const auto open = ch == '}' ? '{' : ch == ')' ? '(' : '[';
+            if (brackets.empty() || brackets.back() != open) {
+              return error(path, line_number, "unbalanced brackets");
+            }
+            brackets.pop_back();
+            break;
+          }
+
+          default:
+            break;
+        }
+      }
+      if (!brackets.empty()) {
+        return error(path, line_number, "unclosed brackets");
+      }
+
+      if (source.find("void main"sv) == std::string_view::npos) {
+        return error(path, 1, "no main function");
+      }
+      return true;
+    }
+
+   private:
+    std::vector<std::filesystem::path> files_{};
+    std::vector<std::filesystem::path> stack_{};
+  };
+
+  auto BakeShader(const std::filesystem::path& input, const std::filesystem::path& output)
+      -> bool {
+    auto source = std::string{};
+    return ShaderBaker{}.bake(input, source) && WriteWholeFile(output, source);
+  }
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  if (argc != 4 || (argv[1] != "model"sv && argv[1] != "shader"sv)) {
+    std::fprintf(stderr, "usage: asset_baker model|shader <input> <output>\n");
+    return 1;
+  }
+
+  const auto input = std::filesystem::path{ argv[2] };
+  const auto output = std::filesystem::path{ argv[3] };
+  const auto baked = argv[1] == "model"sv ? BakeModel(input, output) : BakeShader(input, output);
+  return baked ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// Time the mesh distance queries on two procedural height fields, a million triangles each.
+// usage: distance_benchmark [triangles per mesh]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <brabbit/distance.hpp>
+#include <brabbit/mesh.hpp>
+
+namespace {
+
+  constexpr auto DEFAULT_TRIANGLES = 1000000;
+
+  // Unit square of two triangles per cell, waves of the given frequency and phase on top.
+  auto MakeHeightField(int triangles, float frequency, float phase)
+      -> std::unique_ptr<brabbit::Mesh> {
+    const auto cells = std::max(static_cast<int>(std::sqrt(triangles / 2.0)), 1);
+    const auto side = cells + 1;
+    constexpr auto AMPLITUDE = 0.01f;
+
+    auto vertices = std::vector<glm::vec3>{};
+    auto normals = std::vector<glm::vec3>{};
+    vertices.reserve(static_cast<std::size_t>(side) * side);
+    normals.reserve(static_cast<std::size_t>(side) * side);
+    for (auto y = 0; y < side; ++y) {
+      for (auto x = 0; x < side; ++x) {
+        const auto u = static_cast<float>(x) / cells;
+        const auto v = static_cast<float>(y) / cells;
+        const auto su = std::sin(u * frequency + phase);
+        const auto sv = std::sin(v * frequency + phase);
+        const auto cu = std::cos(u * frequency + phase);
+        const auto cv = std::cos(v * frequency + phase);
+        vertices.emplace_back(u, v, AMPLITUDE * su * sv);
+        normals.push_back(glm::normalize(glm::vec3{
+          -AMPLITUDE * frequency * cu * sv, -AMPLITUDE * frequency * su * cv, 1.0f }));
+      }
+    }
+
+    auto indices = std::vector<glm::uvec3>{};
+    indices.reserve(static_cast<std::size_t>(cells) * cells * 2);
+    for (auto y = 0; y < cells; ++y) {
+      for (auto x = 0; x < cells; ++x) {
+        const auto corner = static_cast<glm::uint>(y * side + x);
+        indices.emplace_back(corner, corner + 1, corner + side + 1);
+        indices.emplace_back(corner, corner + side + 1, corner + side);
+      }
+    }
+
+    return std::make_unique<brabbit::Mesh>(
+        std::move(vertices), std::move(normals), std::move(indices));
+  }
+
+  template <typename _Function>
+  auto Measure(const char* name, _Function&& function) -> void {
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = function();
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    std::printf("%-20s %10.3f ms   %g\n", name, seconds.count() * 1000.0, result);
+  }
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  const auto triangles = argc > 1 ? std::atoi(argv[1]) : DEFAULT_TRIANGLES;
+  if (argc > 2 || triangles <= 0) {
+    std::fprintf(stderr, "usage: distance_benchmark [triangles per mesh]\n");
+    return 1;
+  }
+
+  // the second field hovers above the first, turned a quarter so their edges cross
+  const auto lower = MakeHeightField(triangles, 40.0f, 0.0f);
+  const auto upper = MakeHeightField(triangles, 37.0f, 0.5f);
+  const auto lower_world = glm::mat4{ 1.0f };
+  const auto upper_world =
+      glm::rotate(glm::translate(glm::mat4{ 1.0f }, glm::vec3{ 1.0f, 0.0f, 0.05f }),
+                  glm::radians(90.0f),
+                  glm::vec3{ 0.0f, 0.0f, 1.0f });
+  std::printf("%zu x %zu triangles\n", lower->getIndices().size(), upper->getIndices().size());
+
+  Measure("bvh", [&] {
+    return static_cast<double>(lower->getBvh().getNodes().size() +
+                               upper->getBvh().getNodes().size());
+  });
+  Measure("clearance", [&] {
+    return brabbit::ComputeClearance(*lower, lower_world, *upper, upper_world).distance;
+  });
+  Measure("hausdorff one sided", [&] {
+    return brabbit::ComputeHausdorffDistance(
+        *lower, lower_world, *upper, upper_world, brabbit::HausdorffMode::ONE_SIDED);
+  });
+  Measure("hausdorff symmetric", [&] {
+    return brabbit::ComputeHausdorffDistance(
+        *lower, lower_world, *upper, upper_world, brabbit::HausdorffMode::SYMMETRIC);
+  });
+  Measure("deviation", [&] {
+    const auto deviation = brabbit::ComputeDeviation(*lower, lower_world, *upper, upper_world);
+    return static_cast<double>(*std::max_element(deviation.begin(), deviation.end()));
+  });
+  return 0;
+}
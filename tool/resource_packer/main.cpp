@@ -0,0 +1,157 @@
+// Pack a resource directory into the single file served by brabbit::ResourcePack.
+// usage: resource_packer [--compress] <resource directory> <output pack>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <brabbit/lz.hpp>
+#include <brabbit/pack_format.hpp>
+
+using namespace std::string_view_literals;
+
+namespace {
+
+  struct Input {
+    std::string name{};
+    std::vector<char> stored{};
+    brabbit::PackEntry entry{};
+  };
+
+  auto ReadWholeFile(const std::filesystem::path& path, std::vector<char>& data) -> bool {
+    auto file = std::ifstream{ path, std::ios::binary | std::ios::ate };
+    if (!file) {
+      return false;
+    }
+
+    data.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(data.data(), static_cast<std::streamsize>(data.size())));
+  }
+
+  auto AlignUp(std::uint64_t value) -> std::uint64_t {
+    constexpr auto ALIGNMENT = brabbit::PACK_ALIGNMENT;
+    return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  auto compress = false;
+  auto arguments = std::vector<std::string_view>{};
+  for (auto i = 1; i < argc; ++i) {
+    if (argv[i] == "--compress"sv) {
+      compress = true;
+    } else {
+      arguments.emplace_back(argv[i]);
+    }
+  }
+
+  if (arguments.size() != 2) {
+    std::fprintf(stderr, "usage: resource_packer [--compress] <directory> <output pack>\n");
+    return 1;
+  }
+
+  const auto root = std::filesystem::path{ arguments[0] };
+  const auto output = std::filesystem::path{ arguments[1] };
+  auto error = std::error_code{};
+  if (!std::filesystem::is_directory(root, error)) {
+    std::fprintf(stderr, "resource_packer: %s is not a directory\n", root.string().c_str());
+    return 1;
+  }
+
+  auto inputs = std::vector<Input>{};
+  for (const auto& item : std::filesystem::recursive_directory_iterator{ root }) {
+    if (!item.is_regular_file()) {
+      continue;
+    }
+
+    auto& input = inputs.emplace_back();
+    input.name = item.path().lexically_relative(root).generic_string();
+
+    auto data = std::vector<char>{};
+    if (!ReadWholeFile(item.path(), data)) {
+      std::fprintf(stderr, "resource_packer: can not read %s\n", item.path().string().c_str());
+      return 1;
+    }
+
+    // compressed only when it pays for the decoding, text shrinks well and binaries often do not
+    input.entry.size = data.size();
+    input.entry.compression = brabbit::PackCompression::NONE;
+    if (compress) {
+      auto packed = brabbit::CompressLz(data);
+      if (packed.size() + packed.size() / 8 < data.size()) {
+        data = std::move(packed);
+        input.entry.compression = brabbit::PackCompression::LZ;
+      }
+    }
+    input.entry.stored_size = data.size();
+    input.entry.hash = brabbit::HashResourceName(input.name);
+    input.stored = std::move(data);
+  }
+
+  std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) {
+    return a.entry.hash != b.entry.hash ? a.entry.hash < b.entry.hash : a.name < b.name;
+  });
+
+  auto header = brabbit::PackHeader{};
+  header.entry_count = static_cast<std::uint32_t>(inputs.size());
+  header.names_offset = sizeof(brabbit::PackHeader) + inputs.size() * sizeof(brabbit::PackEntry);
+
+  auto names = std::string{};
+  for (auto& input : inputs) {
+    input.entry.name_offset = static_cast<std::uint32_t>(names.size());
+    input.entry.name_size = static_cast<std::uint32_t>(input.name.size());
+    names += input.name;
+  }
+  header.names_size = names.size();
+
+  auto offset = AlignUp(header.names_offset + header.names_size);
+  for (auto& input : inputs) {
+    input.entry.offset = offset;
+    offset = AlignUp(offset + input.entry.stored_size);
+  }
+
+  // written next to the target and renamed, a failed run never leaves half a pack behind
+  auto temporary = output;
+  temporary += ".tmp";
+  {
+    auto file = std::ofstream{ temporary, std::ios::binary | std::ios::trunc };
+    const auto write = [&file](const void* data, std::size_t size) {
+      file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+    const auto pad = [&file]() {
+      const auto position = static_cast<std::uint64_t>(file.tellp());
+      for (auto i = position; i < AlignUp(position); ++i) {
+        file.put('\0');
+      }
+    };
+
+    write(&header, sizeof(header));
+    for (const auto& input : inputs) {
+      write(&input.entry, sizeof(input.entry));
+    }
+    write(names.data(), names.size());
+    for (const auto& input : inputs) {
+      pad();
+      write(input.stored.data(), input.stored.size());
+    }
+
+    if (!file) {
+      std::fprintf(stderr, "resource_packer: can not write %s\n", temporary.string().c_str());
+      return 1;
+    }
+  }
+
+  std::filesystem::rename(temporary, output, error);
+  if (error) {
+    std::fprintf(stderr, "resource_packer: can not replace %s\n", output.string().c_str());
+    return 1;
+  }
+
+  return 0;
+}